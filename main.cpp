@@ -20,6 +20,12 @@ Resources
 #include <ctime>
 #include <bits/stdc++.h>
 #include <filesystem>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
 
 // Curl
 #include <curl/curl.h>
@@ -36,8 +42,8 @@ using json = nlohmann::json;
 // Global Variables
 bool debug = false;
 bool log_to_file = true;
-bool collapse_threads = false;
-bool interrupt = false;
+std::atomic<bool> collapse_threads(false);
+std::atomic<bool> interrupt(false);
 bool local_instances_updated = false;
 int epoch_time;
 
@@ -52,6 +58,7 @@ const std::string config_file_downloads = configdir + "/downloads.conf";
 const std::string config_file_favorites = configdir + "/favorites.conf";
 const std::string config_file_banned_instances = configdir + "/banned-instances.conf";
 const std::string config_file_banned_channels = configdir + "/banned-channels.conf";
+const std::string cache_file = configdir + "/cache.bin";
 
 // URL Variables
 const std::string URL_instances = "https://api.invidious.io/instances.json?&sort_by=type,users";
@@ -61,19 +68,19 @@ int input_character;
 bool input_character_exit = false;
 bool exit_thread_started = false;
 bool typing_mode = false;
-bool typing_mode_result = false;
 unsigned char char_input_character;
-std::vector <int> input_list;
 std::vector <int> input_list_type;
 
 // UI elements
-bool update_ui = true;
+std::atomic<bool> update_ui(true);
+int ui_event_fd = -1;           // eventfd waking main loop, written by input thread, background worker and signals.
+const int ui_refresh_seconds = 10;  // Redraw interval for relative times, driven by timerfd.
 bool quit = false;
-bool browse_opened = false;
-bool popup_box = false; 
+std::atomic<bool> browse_opened(false);
+std::atomic<bool> popup_box(false);
 bool current_list_loaded = false;
 int current_list_item = 0;
-int current_selected_video = 0;
+std::atomic<int> current_selected_video(0);
 int list_shift = 0;
 
 // Remove:
@@ -113,7 +120,7 @@ const std::string settings_types[3] = {"Preferences", "Instances", "Subscription
 
 // Search Items:
 int search_field = 1; // 0 - Search field, 1 - Video or Channel option
-int search_type = 0; // Types: 0-Videos 1-Channels
+std::atomic<int> search_type(0); // Types: 0-Videos 1-Channels
 
 const std::string logo[5] = {
     "__     ___     _               ____ _ _            _",
@@ -136,6 +143,29 @@ const std::string color_gray   = "\033[90m";
 const std::string frame_title_color = color_green;
 const std::string default_frame_color = color_yellow;
 
+// Screen back buffer, draw functions write cells here and screen_flush sends only changed cells to terminal.
+struct screen_cell {
+    std::string character = " ";    // UTF-8 character, empty for right half of wide character
+    std::string attributes;         // Color escape codes character is drawn with
+    int width = 1;                  // Terminal columns, 2 for wide character, 0 for its right half
+    bool operator== ( const screen_cell& other ) const { return character == other.character && attributes == other.attributes && width == other.width; }
+    bool operator!= ( const screen_cell& other ) const { return ! ( *this == other ); }
+};
+std::vector<screen_cell> screen_back;       // Frame being drawn
+std::vector<screen_cell> screen_front;      // Frame currently shown on terminal
+int screen_w = 0;
+int screen_h = 0;
+int screen_cursor_w = 1;                    // Position for screen_write, set by screen_move. 1 based like terminal.
+int screen_cursor_h = 1;
+bool screen_front_valid = false;            // False if terminal content is unknown, next flush redraws everything.
+
+// Frame composer, each frame is built in frame_buffer and sent to terminal with a single write.
+std::string frame_buffer;
+std::atomic<int> frame_last_bytes(0);       // Bytes sent for last frame
+std::atomic<int> frame_last_syscalls(0);    // write calls needed for last frame
+std::atomic<long> frame_count(0);           // Frames sent
+std::atomic<long> frame_total_bytes(0);     // Bytes sent for all frames
+
 // Input Parameter switches
 bool arg_verbose = false;
 bool arg_help    = false;
@@ -149,6 +179,7 @@ struct inv_videos{                      // invidious videos
     int viewcount;                              // video views
     int downloaded_time = 0;                    // epoch time when video was downloaded
     int retry = 0;                              // Amount of retries done to calculate normal video or not.
+    int last_updated = 0;                       // epoch time video information was last received, used to revalidate cached videos.
     std::string title;                          // video title
     std::string author;                         // video creator
     std::string author_id;                      // ID of video creator
@@ -160,9 +191,11 @@ struct inv_videos{                      // invidious videos
     bool manual_update = false;                 // if video has been manually updated
     bool priority_update = false;               // if true, video will be picked first for information update
     bool normal_video = true;                   // if false, video is live, pre-live or other which breaks logic. Skip if false.
-    bool from_multiple_instances = false;       // if video is found in 2 or more instances
+    int popular_instances = 0;                  // amount of instance popular lists video is in
 };
-std::vector<inv_videos> inv_videos_vector;
+std::deque<inv_videos> inv_videos_vector;                   // Video cache. Deque so growing it never moves existing entries.
+std::unordered_map<std::string, int> inv_videos_index;      // VideoID -> handle (position) in inv_videos_vector. Handles are never reused.
+std::unordered_map<std::string, std::vector<int>> inv_videos_by_author; // Channel ID -> handles of its videos, for subscriptions list.
 
 struct inv_instances{
     bool enabled;               // if the program is going to use this instance
@@ -188,6 +221,7 @@ struct inv_channels{
 std::vector<inv_channels> inv_channels_vector;
 
 std::vector<std::string> vec_browse_popular;            // VideoID's of popular list sorted.
+std::map<std::string, std::vector<int>> popular_lists;  // Popular list of each instance by name, video handles newest first. Merged into vec_browse_popular.
 std::vector<std::string> vec_browse_subscriptions;      // VideoID's of subscribed list sorted.
 std::vector<std::string> vec_browse_downloaded;         // VideoID's of downloads list sorted.
 std::vector<std::string> vec_browse_favorites;          // VideoID's of favorites list sorted.
@@ -197,22 +231,328 @@ std::vector<std::string> vec_search_results_channel;    // ChannelID's of search
 std::vector<std::string> vec_global_banned_instances;   // All banned instances
 std::vector<std::string> vec_global_banned_channels;    // All banned channels
 
-std::vector<std::string> vec_subscribed_channels;       // Locally sourced list of subscribed channel ID's
-std::vector<std::string> vec_downloaded_videos;         // Locally sourced list of downloaded video ID's
-std::vector<std::string> vec_favorited_videos;          // Locally sourced list of favorited video ID's
+
+/*
+    Locally sourced lists are append-only files. Adding writes the ID as a line, removing writes the ID
+    prefixed with a tombstone. The file is replayed at startup and compacted by the worker once dead lines pile up.
+*/
+const char config_list_tombstone = '!';                 // Video and channel ID's never start with this character
+struct config_list{
+    std::string filename;                               // Backing append-only file
+    int fd = -1;                                        // Open append descriptor
+    std::vector<std::string> items;                     // Live ID's, order not preserved on removal
+    std::unordered_map<std::string,size_t> index;       // ID to position in items
+    size_t file_lines = 0;                              // Lines in file including tombstones and removed ID's
+};
+config_list subscribed_channels;                        // Locally sourced list of subscribed channel ID's
+config_list downloaded_videos;                          // Locally sourced list of downloaded video ID's
+config_list favorited_videos;                           // Locally sourced list of favorited video ID's
+
+/*
+    Shared state lock:
+    cache_mutex guards the video, instance and channel vectors, all vec_browse / vec_search lists,
+    the locally sourced lists and input_list_type. The main thread holds a shared lock while drawing,
+    and a unique lock while handling input. Background threads hold a unique lock while parsing and
+    merging, never while waiting on the network.
+    Functions named update_* take the lock themselves, everything they call expects it held.
+*/
+std::shared_mutex cache_mutex;
+
+// On disk cache
+const int cache_version = 2;                    // Bump when cache layout changes, older caches are discarded.
+const int cache_save_interval = 300;            // Seconds between background cache saves
+const int cache_video_max_age = 86400;          // Cached video details older than this are refreshed in background
+int cache_instances_time = 0;                   // When cached instance list was saved, 0 if not loaded from cache
+std::mutex cache_save_mutex;                    // One save at a time, periodic job and exit save share the temporary file
+
+// Curl connection reuse
+CURLSH *curl_share = nullptr;                                           // Shared DNS, TLS session and connection cache
+std::mutex curl_share_mutex[CURL_LOCK_DATA_LAST];                       // Locks for curl_share, one per data type
+std::mutex curl_pool_mutex;                                             // Lock for curl_handle_pool
+std::unordered_map<std::string, std::vector<CURL*>> curl_handle_pool;   // Host -> idle curl handles with open connections
+const int curl_pool_max_idle = 4;                                       // Max idle curl handles kept per host
+std::atomic<int> fetch_connections_new(0);                              // Connections opened by fetch
+std::atomic<int> fetch_connections_reused(0);                           // Requests that reused an open connection
+
+// Instance health, measured from every finished request and used to prefer fast and reliable instances.
+struct instance_health {
+    double latency_ms = 0;      // EWMA of request time
+    double success = 1.0;       // EWMA of request success, 1.0 is always successful
+    int samples = 0;            // Requests measured
+    int breaker_state = 0;      // Circuit breaker: 0 - Closed, 1 - Open, 2 - Half-open with one probe request
+    int failures = 0;           // Consecutive failures
+    int trips = 0;              // Times opened since last success, doubles backoff each time
+    int retry_at = 0;           // epoch time when open breaker lets a probe through, or half-open probe is given up
+};
+std::mutex instance_health_mutex;                                       // Lock for instance_health_map, taken after cache_mutex
+std::unordered_map<std::string, instance_health> instance_health_map;  // Host -> measured health
+struct pending_response {
+    std::string host;
+    double latency_ms;
+    std::chrono::steady_clock::time_point received;
+};
+std::unordered_map<std::string, pending_response> pending_responses;    // URL -> response waiting for body check before health is recorded
+const int pending_response_max_age = 30;                                // Seconds before unchecked response is dropped
+const double instance_health_alpha = 0.2;                               // Weight of newest sample in EWMA
+const double instance_unmeasured_latency_ms = 800;                      // Assumed latency before first request to instance
+const int breaker_failure_threshold = 3;                                // Consecutive failures before instance breaker opens
+const int breaker_backoff_base = 5;                                     // Seconds open after first trip, doubled per trip with jitter
+const int breaker_backoff_max = 600;
+const int breaker_probe_timeout = 10;                                   // Seconds before unanswered half-open probe is given up
+
+// Hedged requests, slow request is raced against the same request to another instance.
+std::mutex request_latency_mutex;                                       // Lock for request_latency_ring
+int request_latency_ring[64] = {};                                      // Latency in ms of recent successful requests
+int request_latency_count = 0;                                          // Requests recorded, ring position is count % 64
+const int hedge_delay_default_ms = 500;                                 // Hedge delay until enough latencies are recorded
+const int hedge_delay_min_ms = 100;
+const int hedge_delay_max_ms = 2000;
+std::atomic<int> hedge_budget(50);                                      // In tenths of a hedge, each hedgeable request adds 1, each hedge costs 10
+const int hedge_budget_max = 50;                                        // Max 5 hedges in a burst, about 10% extra requests over time
+std::atomic<int> fetch_hedges_sent(0);                                  // Hedge requests sent
+std::atomic<int> fetch_hedges_won(0);                                   // Hedge requests that answered first
+
+// Cancellable fetch, request is aborted once generation moves on from expected or deadline passes.
+struct fetch_cancel {
+    const std::atomic<int> *generation;
+    int expected;
+    std::chrono::steady_clock::time_point deadline;
+};
+
+// Background jobs, queued per priority class and run by a pool of job threads, highest class first.
+enum job_priority { job_interactive, job_search, job_visible, job_background, job_speculative, job_priority_count };
+const char *job_priority_names[job_priority_count] = { "Interactive", "Search", "Visible", "Background", "Speculative" };
+struct job {
+    std::string key;                            // Identifies job, a job with same key is not queued twice
+    std::function<bool()> work;                 // Returns false on failure, job key then backs off
+};
+struct job_backoff {
+    std::chrono::steady_clock::time_point next_eligible;
+    int failures = 0;
+};
+std::mutex job_mutex;                           // Lock for job_queues and job_keys
+std::condition_variable job_cv;                 // Wakes job threads for new job
+std::deque<job> job_queues[job_priority_count]; // Waiting jobs per priority class
+std::unordered_set<std::string> job_keys;       // Keys of queued and running jobs
+std::unordered_map<std::string, job_backoff> job_backoffs; // Keys whose last run failed, not queued again until eligible
+const int job_backoff_base_ms = 2000;           // Wait after first failure, doubled for each further failure
+const int job_backoff_max_ms = 60000;
+int job_threads = 3;                            // Job threads, set with -j. With 2 or more, first thread only runs interactive and search jobs.
+std::atomic<int> jobs_completed(0);
+std::mutex scheduler_mutex;                     // Lock for scheduler_wake
+std::condition_variable scheduler_cv;           // Wakes scheduler to plan jobs before next tick
+bool scheduler_wake = false;
+
+// Rows shown in video list, published by draw_list_videos and prefetched by scheduler.
+std::mutex viewport_mutex;                      // Lock for viewport_visible, viewport_upcoming and viewport_generation
+std::vector<int> viewport_visible;              // Shown video handles missing details, nearest to cursor first
+std::vector<int> viewport_upcoming;             // Next page in scroll direction missing details
+int viewport_generation = 0;                    // Increased when shown rows change
+int viewport_last_item = 0;                     // Cursor at last draw, for scroll direction. Used by UI only.
+int viewport_direction = 1;                     // Scroll direction, 1 - down, -1 - up
+const int viewport_retry_seconds = 5;           // Wait before fetching failed rows again
+
+// Searches run as jobs, a newer search makes running one stop.
+std::mutex search_mutex;                        // Lock for search_cv
+std::condition_variable search_cv;              // Wakes search backing off when newer search is submitted
+std::atomic<int> search_generation(0);          // Increased by each new search, running search stops when it changes
+std::atomic<bool> search_running(false);        // Search job in progress
+std::string search_status;                      // Progress or failure shown under search box, guarded by cache_mutex
+const int search_deadline_seconds = 20;         // Whole search, all attempts included
+
+// Concurrent fetching
+struct fetch_request {
+    std::string url;                                            // Request URL
+    std::function<void(bool, const std::string&)> on_complete;  // Receives success and response body
+    std::function<void(bool, const std::string&)> on_parse;     // Optional, parses body on parse pool before on_complete
+};
+const int fetch_max_in_flight = 8;                              // Default max concurrent requests for fetch_many
+const int fetch_max_attempts = 4;                               // Instances tried before a single update gives up until next cycle
+
+// Parse pool, work stealing threads parsing response bodies while fetching continues.
+struct parse_task_queue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;                    // Owner takes newest from back, other threads steal oldest from front
+};
+// Parse tasks of one fetch, waited on by submitting thread.
+struct parse_group {
+    std::mutex mutex;
+    std::condition_variable cv;
+    int pending = 0;
+};
+const int parse_max_threads = 8;
+parse_task_queue parse_queues[parse_max_threads];
+int parse_threads = 0;                                          // Started parse threads, one per core. 0 runs tasks on submitting thread.
+std::atomic<int> parse_queued(0);                               // Tasks waiting in all queues
+std::atomic<unsigned int> parse_next_queue(0);                  // Queue for next task submitted from outside pool
+std::mutex parse_idle_mutex;
+std::condition_variable parse_idle_cv;                          // Wakes idle parse threads
+thread_local int parse_thread_index = -1;                       // Own queue of parse thread, -1 outside pool
+std::atomic<long long> parse_tasks_done(0);
+std::atomic<long long> parse_tasks_stolen(0);
+
+// API endpoints, requests ask only for the fields their parser reads.
+enum api_endpoint { api_video_info, api_popular, api_channel_videos, api_search, api_endpoint_count };
+struct api_endpoint_info {
+    const char* name;                                           // Name shown on status page
+    const char* fields;                                         // Value of fields= parameter
+    std::atomic<bool> baseline_claimed{false};                  // With -v, first request is sent without fields= to measure savings
+    std::atomic<long long> baseline_bytes{0};                   // Bytes received without projection
+    std::atomic<int> baseline_requests{0};
+    std::atomic<long long> projected_bytes{0};                  // Bytes received with projection
+    std::atomic<int> projected_requests{0};
+};
+api_endpoint_info api_endpoints[api_endpoint_count] = {
+    { "Video info", "title,description,published,viewCount,author,authorId,lengthSeconds" },
+    { "Popular",    "videoId,title,lengthSeconds,published,viewCount,author,authorId" },
+    { "Channel",    "videos(videoId,title,lengthSeconds,published,viewCount,author,authorId,liveNow,premium,isUpcoming)" },
+    { "Search",     "videoId,title,lengthSeconds,published,viewCount,author,authorId" },
+};
+
+// Bounded lock-free ring buffer for exactly one producer thread and one consumer thread.
+template <typename T, size_t capacity>
+class spsc_ring {
+    static_assert(( capacity & ( capacity - 1 )) == 0, "spsc_ring capacity must be a power of 2");
+public:
+    // Producer side, returns false if full.
+    bool push ( const T& item ) {
+        size_t tail = write_index.load(std::memory_order_relaxed);
+        if ( tail - read_index.load(std::memory_order_acquire) == capacity ) {
+            return false;
+        }
+        items[tail & ( capacity - 1 )] = item;
+        write_index.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+    // Consumer side, returns false if empty.
+    bool pop ( T& item ) {
+        size_t head = read_index.load(std::memory_order_relaxed);
+        if ( head == write_index.load(std::memory_order_acquire) ) {
+            return false;
+        }
+        item = items[head & ( capacity - 1 )];
+        read_index.store(head + 1, std::memory_order_release);
+        return true;
+    }
+private:
+    T items[capacity];
+    alignas(64) std::atomic<size_t> write_index{0};
+    alignas(64) std::atomic<size_t> read_index{0};
+};
+spsc_ring<unsigned char, 4096> input_ring;    // Raw key bytes from input thread to main thread.
+
+// Bounded lock-free queue for many producer threads and one consumer thread, messages are copied into fixed size slots.
+template <size_t capacity, size_t slot_size>
+class mpsc_queue {
+    static_assert(( capacity & ( capacity - 1 )) == 0, "mpsc_queue capacity must be a power of 2");
+public:
+    mpsc_queue () {
+        for ( size_t i = 0; i < capacity; ++i ) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    // Producer side, message is truncated to slot size but keeps its last byte as terminator. Returns false if full.
+    bool push ( const char* data, size_t length ) {
+        size_t position = write_index.load(std::memory_order_relaxed);
+        slot* current;
+        while ( true ) {
+            current = &slots[position & ( capacity - 1 )];
+            intptr_t difference = (intptr_t)current->sequence.load(std::memory_order_acquire) - (intptr_t)position;
+            if ( difference == 0 ) {
+                if ( write_index.compare_exchange_weak(position, position + 1, std::memory_order_relaxed) ) {
+                    break;
+                }
+            } else if ( difference < 0 ) {
+                return false;
+            } else {
+                position = write_index.load(std::memory_order_relaxed);
+            }
+        }
+        if ( length > slot_size ) {
+            std::memcpy(current->data, data, slot_size - 1);
+            current->data[slot_size - 1] = data[length - 1];
+            current->length = slot_size;
+        } else {
+            std::memcpy(current->data, data, length);
+            current->length = length;
+        }
+        current->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+    // Consumer side, appends message to output. Returns false if empty.
+    bool pop ( std::string& output ) {
+        slot& current = slots[read_index & ( capacity - 1 )];
+        if ( current.sequence.load(std::memory_order_acquire) != read_index + 1 ) {
+            return false;
+        }
+        output.append(current.data, current.length);
+        current.sequence.store(read_index + capacity, std::memory_order_release);
+        ++read_index;
+        return true;
+    }
+    // Consumer side
+    bool empty () {
+        return slots[read_index & ( capacity - 1 )].sequence.load(std::memory_order_seq_cst) != read_index + 1;
+    }
+private:
+    struct slot {
+        std::atomic<size_t> sequence;
+        size_t length;
+        char data[slot_size];
+    };
+    slot slots[capacity];
+    alignas(64) std::atomic<size_t> write_index{0};
+    alignas(64) size_t read_index = 0;
+};
+
+// Asynchronous log writer, log() only queues lines and THREAD_log_writer writes them in batches.
+mpsc_queue<4096, 512> log_queue;                // Formatted log lines waiting to be written
+std::atomic<bool> log_writer_sleeping(false);   // Writer waits on log_event_fd, producers wake it
+std::atomic<bool> log_writer_stop(false);       // Flush remaining lines and stop writer
+std::atomic<int> log_dropped(0);                // Lines dropped because queue was full
+int log_event_fd = -1;
+const off_t log_max_size = 4 * 1024 * 1024;     // Rotate log file to .1 when it grows past this
+const size_t log_batch_max = 64 * 1024;         // Max bytes per write
+
+// Decoded key press. Arrow keys: 0-Null, 1-UP, 2-Down, 3-Left, 4-Right
+struct key_event {
+    int key;            // ascii key, 27 for escape, 0 for arrow keys
+    int arrow;          // arrow type
+};
+// Escape sequence decoder state
+struct key_decoder {
+    int state = 0;                                      // 0 - Normal, 1 - Got escape, 2 - Got CSI "ESC [", 3 - Got SS3 "ESC O"
+    std::chrono::steady_clock::time_point escape_time;  // When escape was received, lone escape after timeout.
+};
+key_decoder input_decoder;
+const int escape_timeout_ms = 25;   // Time to wait for rest of escape sequence before treating it as escape key.
 
 void usage () {
     const char *usage_text = R""""(usage: video-client
 
 Arguments:
     -h, --help                      Show this page
-    -v, --verbose, --debug          Show debug logs)"""";
+    -v, --verbose, --debug          Show debug logs
+    -jN                             Run background work on N threads, default 3)"""";
 
     std::cout << usage_text << "\n";
 }
 int epoch () {
     return std::time(0);
 }
+// Wake main loop. Async signal safe.
+void wake_ui () {
+    if ( ui_event_fd != -1 ) {
+        uint64_t one = 1;
+        ssize_t written = write(ui_event_fd, &one, sizeof(one));
+        (void)written; // Counter full means main loop is allready woken.
+    }
+}
+// Ask main loop to redraw UI from another thread.
+void request_ui_update () {
+    update_ui = true;
+    wake_ui();
+}
 bool create_folder ( const std::string& folderPath ) {
     if ( ! std::filesystem::exists(folderPath) ) {
         try {
@@ -268,28 +608,8 @@ bool find_string_in_file ( const std::string& filename, const std::string& conte
     }
     return false; // String not found in the file
 }
-// append string to file
-int append_file ( const std::string& filename, const std::string& content, bool newline = false ) { // 0 = added, 1 = allready in file, 2 fail.
-    if ( find_string_in_file(filename, content) ) {
-        return 1;
-    }
-
-    std::ofstream file;
-    file.open(filename, std::ios::app);
-    if (file.is_open()) {
-        if ( newline ) {
-            file << content << "\n";
-        } else {
-            file << content;
-        }
-        file.close();
-        return 0;
-    } else {
-        return 2;
-    }
-}
 // Log function
-void log ( std::string message, int severity = 0 ) {
+void log ( const std::string& message, int severity = 0 ) {
 
     if ( debug == false ) {
         if ( severity == 0 ) { // Skip debug logs if not verbose
@@ -297,7 +617,7 @@ void log ( std::string message, int severity = 0 ) {
         }
     }
 
-    std::string severity_prefix;
+    const char* severity_prefix = "";
 
     if ( severity == 0 ) {
         severity_prefix = "DEBUG  ";
@@ -311,7 +631,7 @@ void log ( std::string message, int severity = 0 ) {
         severity_prefix = "FATAL! ";
     }
 
-    std::string fullmsg;
+    thread_local std::string fullmsg; // Reused, no allocation once grown.
 
     if ( ! log_to_file ) {
         if ( severity == 0 || severity == 1 ) {
@@ -327,10 +647,138 @@ void log ( std::string message, int severity = 0 ) {
             std::cerr << fullmsg;
         }
     } else if ( log_to_file == true ) {
-        fullmsg = severity_prefix + " - " + message + "\n";
-        append_file(logfile, fullmsg);
+        fullmsg.clear();
+        fullmsg += severity_prefix;
+        fullmsg += " - ";
+        fullmsg += message;
+        fullmsg += '\n';
+        if ( ! log_queue.push(fullmsg.data(), fullmsg.size()) ) {
+            ++log_dropped;
+        } else if ( log_writer_sleeping.exchange(false) ) {
+            uint64_t one = 1;
+            ssize_t written = write(log_event_fd, &one, sizeof(one));
+            (void)written;
+        }
     }
 }
+// Append log format argument to line
+void log_append ( std::string& line, const std::string& value ) {
+    line += value;
+}
+void log_append ( std::string& line, const char* value ) {
+    line += value;
+}
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value>::type log_append ( std::string& line, T value ) {
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    line.append(buffer, result.ptr - buffer);
+}
+// Replace each "{}" in format with next argument
+void log_format_next ( std::string& line, const char* format ) {
+    line += format;
+}
+template <typename T, typename... Args>
+void log_format_next ( std::string& line, const char* format, const T& value, const Args&... args ) {
+    const char* placeholder = std::strstr(format, "{}");
+    if ( placeholder == nullptr ) {
+        line += format;
+        return;
+    }
+    line.append(format, placeholder - format);
+    log_append(line, value);
+    log_format_next(line, placeholder + 2, args...);
+}
+// Log with format arguments, severity is checked before anything is formatted. Ex. log_format(2, "Video: {} Returned Error: {}", videoid, error)
+template <typename... Args>
+void log_format ( int severity, const char* format, const Args&... args ) {
+    if (( severity == 0 ) && ( ! debug )) {
+        return;
+    }
+    thread_local std::string line;
+    line.clear();
+    log_format_next(line, format, args...);
+    log(line, severity);
+}
+// Debug log with format arguments, compiled out together with its arguments in release builds.
+#ifdef NDEBUG
+#define log_debug(...) ((void)0)
+#else
+#define log_debug(...) log_format(0, __VA_ARGS__)
+#endif
+// Open log file for appending, returns fd and sets size.
+int log_open ( off_t& size ) {
+    int fd = open(logfile.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    struct stat file_stat;
+    size = ( fd != -1 && fstat(fd, &file_stat) == 0 ) ? file_stat.st_size : 0;
+    return fd;
+}
+// Log writer thread, drains log queue and writes each batch with one write to log file kept open.
+void THREAD_log_writer () {
+    off_t size;
+    int fd = log_open(size);
+    if ( fd == -1 ) {
+        std::cerr << "Unable to open log file: " << logfile << std::endl;
+    }
+    std::string batch;
+    while ( true ) {
+        bool stopping = log_writer_stop;
+        batch.clear();
+        while (( batch.size() < log_batch_max ) && log_queue.pop(batch) ) {}
+        int dropped = log_dropped.exchange(0);
+        if ( dropped != 0 ) {
+            batch += "WARNING - Log queue full, dropped " + std::to_string(dropped) + " lines.\n";
+        }
+        if ( batch.size() != 0 ) {
+            if (( fd != -1 ) && ( size + (off_t)batch.size() > log_max_size )) { // Rotate
+                close(fd);
+                std::string rotated_file = logfile + ".1";
+                rename(logfile.c_str(), rotated_file.c_str());
+                fd = log_open(size);
+            }
+            if ( fd != -1 ) {
+                ssize_t written = write(fd, batch.data(), batch.size());
+                if ( written > 0 ) {
+                    size += written;
+                }
+            }
+            continue;
+        }
+        if ( stopping ) {
+            break;
+        }
+        log_writer_sleeping = true;
+        if ( log_queue.empty() && ( ! log_writer_stop )) {
+            struct pollfd event = { log_event_fd, POLLIN, 0 };
+            poll(&event, 1, 1000); // Timeout only as a safety net
+        }
+        log_writer_sleeping = false;
+        uint64_t count;
+        ssize_t received = read(log_event_fd, &count, sizeof(count));
+        (void)received;
+    }
+    if ( fd != -1 ) {
+        close(fd);
+    }
+}
+// Start log writer thread, lines logged before this are kept in queue.
+std::thread start_log_writer () {
+    log_event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    return std::thread(THREAD_log_writer);
+}
+// Flush queued log lines and stop log writer thread.
+void stop_log_writer ( std::thread& log_thread ) {
+    if ( ! log_thread.joinable() ) {
+        return;
+    }
+    log_writer_stop = true;
+    if ( log_writer_sleeping.exchange(false) ) {
+        uint64_t one = 1;
+        ssize_t written = write(log_event_fd, &one, sizeof(one));
+        (void)written;
+    }
+    log_thread.join();
+}
 // Ascii vector to string
 std::string ascii_vector_to_string ( std::vector<int> ascii, bool url = false ) {
     std::string result;
@@ -346,33 +794,141 @@ std::string ascii_vector_to_string ( std::vector<int> ascii, bool url = false )
     }
     return result;
 }
-// remove line from file
-void remove_matching_lines ( const std::string& filename, const std::string& pattern ) {
-    std::ifstream inFile(filename);
-    std::vector<std::string> lines;
-    std::string line;
-    int string_length = pattern.length();
-
-    if ( string_length == 0 ) {
-        log("Attempted to remove null string from file: " + filename, 3);
+// Check if ID is in local list
+bool config_list_contains ( const config_list& list, const std::string& id ) {
+    return list.index.find(id) != list.index.end();
+}
+// Insert ID in memory only
+bool config_list_insert ( config_list& list, const std::string& id ) {
+    if ( config_list_contains(list, id) ) {
+        return false;
     }
-
-    while (std::getline(inFile, line)) {
-        lines.push_back(line);
+    list.index[id] = list.items.size();
+    list.items.push_back(id);
+    return true;
+}
+// Erase ID in memory only, last item is moved into the gap.
+bool config_list_erase ( config_list& list, const std::string& id ) {
+    auto found = list.index.find(id);
+    if ( found == list.index.end() ) {
+        return false;
     }
-    inFile.close();
-
-    auto i = lines.begin();
-    while (i != lines.end()) {
-        if (i->find(pattern) != std::string::npos) {
-            i = lines.erase(i);
-        } else { ++i; }
+    size_t position = found->second;
+    list.index.erase(found);
+    if ( position != list.items.size() - 1 ) {
+        list.items[position] = std::move(list.items.back());
+        list.index[list.items[position]] = position;
+    }
+    list.items.pop_back();
+    return true;
+}
+// Append one line to list file
+bool config_list_write ( config_list& list, const std::string& line ) {
+    if ( list.fd == -1 ) {
+        log_format(3, "Local list file not open: {}", list.filename);
+        return false;
+    }
+    std::string buffer = line + "\n";
+    if ( write(list.fd, buffer.data(), buffer.size()) != (ssize_t)buffer.size() ) {
+        log_format(3, "Unable to append to file: {}", list.filename);
+        return false;
+    }
+    ++list.file_lines;
+    return true;
+}
+// Load local list by replaying its file, and keep file open for appending.
+bool config_list_load ( config_list& list, const std::string& filename ) {
+    list.filename = filename;
+    list.items.clear();
+    list.index.clear();
+    list.file_lines = 0;
+
+    int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if ( fd == -1 ) {
+        log_format(3, "Unable to open file: {}", filename);
+        return false;
+    }
+    struct stat file_stat;
+    if ( fstat(fd, &file_stat) == 0 && file_stat.st_size > 0 ) {
+        void* mapped = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if ( mapped != MAP_FAILED ) {
+            const char* data = (const char*)mapped;
+            size_t line_start = 0;
+            size_t file_size = file_stat.st_size;
+            for ( size_t position = 0; position <= file_size; ++position ) {
+                if ( position == file_size || data[position] == '\n' ) {
+                    if ( position > line_start ) {
+                        ++list.file_lines;
+                        if ( data[line_start] == config_list_tombstone ) {
+                            config_list_erase(list, std::string(data + line_start + 1, position - line_start - 1));
+                        } else {
+                            config_list_insert(list, std::string(data + line_start, position - line_start));
+                        }
+                    }
+                    line_start = position + 1;
+                }
+            }
+            munmap(mapped, file_stat.st_size);
+        } else {
+            log_format(3, "Unable to map file: {}", filename);
+        }
     }
+    close(fd);
 
-    std::ofstream outFile(filename);
-    for (const std::string& updatedLine : lines) {
-        outFile << updatedLine << '\n';
+    list.fd = open(filename.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if ( list.fd == -1 ) {
+        log_format(3, "Unable to open file for appending: {}", filename);
+        return false;
+    }
+    log_debug("Loaded {} entries from: {} ({} lines)", list.items.size(), filename, list.file_lines);
+    return true;
+}
+// Add ID to local list. 0 = added, 1 = allready in list, 2 fail.
+int config_list_add ( config_list& list, const std::string& id ) {
+    if ( id.size() == 0 || id[0] == config_list_tombstone ) {
+        log_format(3, "Attempted to add invalid entry to file: {}", list.filename);
+        return 2;
+    }
+    if ( ! config_list_insert(list, id) ) {
+        return 1;
     }
+    return config_list_write(list, id) ? 0 : 2;
+}
+// Remove ID from local list by appending a tombstone. 0 = removed, 1 = not in list, 2 fail.
+int config_list_remove ( config_list& list, const std::string& id ) {
+    if ( ! config_list_erase(list, id) ) {
+        return 1;
+    }
+    return config_list_write(list, config_list_tombstone + id) ? 0 : 2;
+}
+// Rewrite list file with only live entries, once dead lines outnumber live ones.
+bool config_list_compact ( config_list& list ) {
+    if ( list.file_lines <= list.items.size() * 2 + 32 ) {
+        return false;
+    }
+    std::string buffer;
+    for ( const std::string& item : list.items ) {
+        buffer += item + "\n";
+    }
+    std::string temporary_file = list.filename + ".tmp";
+    int fd = open(temporary_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if ( fd == -1 ) {
+        log_format(3, "Unable to compact file: {}", list.filename);
+        return false;
+    }
+    bool written = write(fd, buffer.data(), buffer.size()) == (ssize_t)buffer.size();
+    close(fd);
+    if ( ! written || rename(temporary_file.c_str(), list.filename.c_str()) != 0 ) {
+        log_format(3, "Unable to compact file: {}", list.filename);
+        return false;
+    }
+    log_debug("Compacted {} from {} to {} lines.", list.filename, list.file_lines, list.items.size());
+    if ( list.fd != -1 ) {
+        close(list.fd);
+    }
+    list.fd = open(list.filename.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    list.file_lines = list.items.size();
+    return list.fd != -1;
 }
 // Random number
 int random_number ( const int min, const int max ) { // Can return both the min and max values, aswell as every in between.
@@ -491,13 +1047,194 @@ std::string truncate(const std::string& input, int max) {
         return input.substr(0, max - 3) + "...";
     }
 }
+// Resize screen buffers to terminal size, forcing full redraw if size changed.
+void screen_resize ( int w, int h ) {
+    if ( w == screen_w && h == screen_h ) {
+        return;
+    }
+    screen_w = w;
+    screen_h = h;
+    screen_back.assign(w * h, screen_cell());
+    screen_front.assign(w * h, screen_cell());
+    screen_front_valid = false;
+    frame_buffer.reserve(w * h * 16); // Full redraw with color codes fits without reallocating
+}
+// Forget terminal content, next flush redraws everything.
+void screen_invalidate () {
+    screen_front_valid = false;
+}
+// Clear back buffer before drawing new frame.
+void screen_clear () {
+    std::fill(screen_back.begin(), screen_back.end(), screen_cell());
+}
+// Move write position, same coordinates as "\033[h;wH".
+void screen_move ( int h, int w ) {
+    screen_cursor_h = h;
+    screen_cursor_w = w < 1 ? 1 : w;
+}
+// Length in bytes of UTF-8 character starting with byte.
+int utf8_char_length ( unsigned char byte ) {
+    if ( byte < 0x80 ) { return 1; }
+    if (( byte & 0xE0 ) == 0xC0 ) { return 2; }
+    if (( byte & 0xF0 ) == 0xE0 ) { return 3; }
+    if (( byte & 0xF8 ) == 0xF0 ) { return 4; }
+    return 1;
+}
+// Terminal columns taken by UTF-8 character, 0 for combining characters.
+int utf8_char_width ( const std::string& text, size_t i, int length ) {
+    if ( length == 1 ) {
+        return 1;
+    }
+    wchar_t code_point = text[i] & ( 0x7F >> length );
+    for ( int byte = 1; byte < length; ++byte ) {
+        code_point = ( code_point << 6 ) | ( text[i + byte] & 0x3F );
+    }
+    int width = wcwidth(code_point);
+    return width < 0 ? 1 : width; // Unknown to locale, assume narrow
+}
+// Replace both halves of wide character touching cell with spaces, before cell is overwritten.
+void screen_split_wide ( int h, int w ) {
+    screen_cell& cell = screen_back[h * screen_w + w];
+    if (( cell.width == 0 ) && ( w > 0 )) {
+        screen_back[h * screen_w + w - 1] = screen_cell();
+    } else if (( cell.width == 2 ) && ( w + 1 < screen_w )) {
+        screen_back[h * screen_w + w + 1] = screen_cell();
+    }
+    cell = screen_cell();
+}
+// Write text at write position with attributes, one cell per terminal column. Wide characters take two cells. Text outside screen is clipped.
+void screen_write ( const std::string& text, const std::string& attributes = "" ) {
+    size_t i = 0;
+    while ( i < text.size() ) {
+        int length = utf8_char_length(text[i]);
+        if ( i + length > text.size() ) {
+            break;
+        }
+        int h = screen_cursor_h - 1;
+        int w = screen_cursor_w - 1;
+        int width = utf8_char_width(text, i, length);
+        if ( width == 0 ) { // Combining character, joins previous cell
+            if ( h >= 0 && h < screen_h && w > 0 && w <= screen_w && screen_back[h * screen_w + w - 1].width == 1 ) {
+                screen_back[h * screen_w + w - 1].character.append(text, i, length);
+            }
+            i += length;
+            continue;
+        }
+        if ( h >= 0 && h < screen_h && w >= 0 && w < screen_w ) {
+            screen_split_wide(h, w);
+            screen_cell& cell = screen_back[h * screen_w + w];
+            if (( unsigned char )text[i] < 0x20 ) { // Control characters would break the layout
+                cell.character = " ";
+            } else if (( width == 2 ) && ( w + 1 >= screen_w )) { // Wide character does not fit on line
+                cell.character = " ";
+                width = 1;
+            } else {
+                cell.character.assign(text, i, length);
+            }
+            cell.attributes = attributes;
+            cell.width = width;
+            if ( width == 2 ) {
+                screen_split_wide(h, w + 1);
+                screen_cell& right = screen_back[h * screen_w + w + 1];
+                right.character.clear();
+                right.attributes = attributes;
+                right.width = 0;
+            }
+        }
+        screen_cursor_w += width;
+        i += length;
+    }
+}
+// Add changed cells to frame buffer, moving cursor only where cells are not contiguous.
+void screen_flush () {
+    std::string& output = frame_buffer;
+    std::string attributes;     // Attributes terminal currently draws with
+    int cursor_h = -1;          // Terminal cursor, -1 if unknown
+    int cursor_w = -1;
+
+    output += color_reset;
+    if ( ! screen_front_valid ) {
+        output += "\033[2J";
+        std::fill(screen_front.begin(), screen_front.end(), screen_cell());
+    }
+
+    for ( int h = 0; h < screen_h; ++h ) {
+        for ( int w = 0; w < screen_w; ++w ) {
+            int cell = h * screen_w + w;
+            if ( screen_back[cell] == screen_front[cell] ) {
+                continue;
+            }
+            if ( screen_back[cell].width == 0 ) { // Right half, drawn with its wide character
+                screen_front[cell] = screen_back[cell];
+                continue;
+            }
+            if ( cursor_h == h && cursor_w < w && cursor_w != -1 ) { // Same line, move forward
+                bool rewrite_gap = w - cursor_w <= 4;
+                for ( int gap = cursor_w; gap < w && rewrite_gap; ++gap ) {
+                    rewrite_gap = ( screen_back[h * screen_w + gap].attributes == attributes ) && ( screen_back[h * screen_w + gap].width == 1 );
+                }
+                if ( rewrite_gap ) { // Unchanged cells in short gap are cheaper to resend than a cursor move
+                    for ( int gap = cursor_w; gap < w; ++gap ) {
+                        output += screen_back[h * screen_w + gap].character;
+                    }
+                } else {
+                    output += "\033[" + std::to_string(w - cursor_w) + "C";
+                }
+            } else if ( cursor_h != h || cursor_w != w ) {
+                output += "\033[" + std::to_string(h + 1) + ";" + std::to_string(w + 1) + "H";
+            }
+            if ( screen_back[cell].attributes != attributes ) {
+                output += color_reset;
+                output += screen_back[cell].attributes;
+                attributes = screen_back[cell].attributes;
+            }
+            output += screen_back[cell].character;
+            cursor_h = h;
+            cursor_w = w + screen_back[cell].width;
+            screen_front[cell] = screen_back[cell];
+            if ( screen_back[cell].width == 2 ) {
+                screen_front[cell + 1] = screen_back[cell + 1];
+            }
+        }
+    }
+    if ( attributes.size() != 0 ) {
+        output += color_reset;
+    }
+    screen_front_valid = true;
+}
+// Send composed frame to terminal with one write, and count bytes and syscalls.
+void frame_write () {
+    const char *data = frame_buffer.data();
+    size_t left = frame_buffer.size();
+    int syscalls = 0;
+    while ( left > 0 ) {
+        ssize_t written = write(STDOUT_FILENO, data, left);
+        ++syscalls;
+        if ( written < 0 ) {
+            if ( errno == EINTR || errno == EAGAIN ) {
+                continue;
+            }
+            break; // Terminal gone
+        }
+        data += written;
+        left -= written;
+    }
+    frame_last_bytes = frame_buffer.size();
+    frame_last_syscalls = syscalls;
+    ++frame_count;
+    frame_total_bytes += frame_buffer.size();
+    frame_buffer.clear(); // Keeps capacity for next frame
+}
 // Draw description
 void description ( int top_w, int top_h, int bot_w, int bot_h, std::string description ) {
     int w = top_w;
     int h = top_h;
-    char escape_newline = '\n';
-    for(char& c : description) { // loops over all characters in string
-        if ( c == escape_newline ) {
+    size_t i = 0;
+    while ( i < description.size() ) { // loops over all characters in string
+        int length = utf8_char_length(description[i]);
+        std::string c = description.substr(i, length);
+        i += length;
+        if ( c == "\n" ) {
             ++h;
             w = top_w;
             continue;
@@ -511,51 +1248,186 @@ void description ( int top_w, int top_h, int bot_w, int bot_h, std::string descr
         }
         if ( h >= bot_h - 1 ) {
             if ( w >= bot_w - 3 ) {
-                printf("...");
+                screen_move(h, w);
+                screen_write("...");
                 break;
             }
             if ( h >= bot_h ) {
                 break;
             }
         }
-        printf("\033[%d;%dH%c", h, w, c);
+        screen_move(h, w);
+        screen_write(c);
         ++w;
     }
 }
 // Get videoid from main video vector
-std::pair<bool, int> get_videoid_from_vector ( std::string id ) {
-    for ( int i = 0; i < inv_videos_vector.size(); ++i ) {
-        if ( inv_videos_vector[i].URL == id ) {
-            return std::make_pair(true, i);
+std::pair<bool, int> get_videoid_from_vector ( const std::string& id ) {
+    auto index = inv_videos_index.find(id);
+    if ( index == inv_videos_index.end() ) {
+        return std::make_pair(false, 0);
+    }
+    return std::make_pair(true, index->second);
+}
+// Set channel of video, keeping channel index up to date.
+void set_video_author ( const int handle, const std::string& author_id ) {
+    std::string& current = inv_videos_vector[handle].author_id;
+    if ( current == author_id ) {
+        return;
+    }
+    if ( ! current.empty() ) {
+        std::vector<int>& handles = inv_videos_by_author[current];
+        handles.erase(std::find(handles.begin(), handles.end(), handle));
+        if ( handles.size() == 0 ) {
+            inv_videos_by_author.erase(current);
+        }
+    }
+    current = author_id;
+    if ( ! author_id.empty() ) {
+        inv_videos_by_author[author_id].push_back(handle);
+    }
+}
+// Add new video to main video vector and index, returns handle of new video.
+int add_video_to_vector ( const std::string& id ) {
+    int handle = inv_videos_vector.size();
+    inv_videos_vector.push_back(inv_videos());
+    inv_videos_vector[handle].URL = id;
+    inv_videos_index[id] = handle;
+    return handle;
+}
+// Record result of request to host in its health stats and circuit breaker. Negative latency for failures without timing, ex. bad response.
+void record_instance_health ( const std::string& host, bool success, double latency_ms ) {
+    std::lock_guard<std::mutex> lock(instance_health_mutex);
+    instance_health& health = instance_health_map[host];
+    if ( health.samples == 0 ) {
+        health.latency_ms = latency_ms < 0 ? instance_unmeasured_latency_ms : latency_ms;
+        health.success = success ? 1.0 : 0.0;
+    } else {
+        if ( latency_ms >= 0 ) {
+            health.latency_ms += instance_health_alpha * ( latency_ms - health.latency_ms );
         }
+        health.success += instance_health_alpha * (( success ? 1.0 : 0.0 ) - health.success );
+    }
+    ++health.samples;
+
+    if ( success ) {
+        health.breaker_state = 0;
+        health.failures = 0;
+        health.trips = 0;
+        return;
+    }
+    ++health.failures;
+    if (( health.breaker_state == 2 ) || (( health.breaker_state == 0 ) && ( health.failures >= breaker_failure_threshold ))) {
+        ++health.trips;
+        int backoff = std::min(breaker_backoff_base << std::min(health.trips - 1, 7), breaker_backoff_max);
+        health.breaker_state = 1;
+        health.retry_at = epoch() + backoff / 2 + random_number(0, backoff); // 0.5x - 1.5x backoff
+        log_format(2, "Instance failing, pausing requests for {} seconds: {}", health.retry_at - epoch(), host);
     }
-    return std::make_pair(false, 0);
 }
-// Get random instance
-std::pair<bool, int> get_random_instance () {
-    if ( inv_instances_vector.size() == 0 ) {
-        return std::make_pair(false, 0);
+// Hold successful response until its body is checked, health is then recorded once by record_response_health.
+void hold_response_health ( const std::string& url, const std::string& host, double latency_ms ) {
+    std::lock_guard<std::mutex> lock(instance_health_mutex);
+    auto now = std::chrono::steady_clock::now();
+    if ( pending_responses.size() > 64 ) { // Drop responses nobody checked, ex. lost hedge
+        for ( auto entry = pending_responses.begin(); entry != pending_responses.end(); ) {
+            if ( now - entry->second.received > std::chrono::seconds(pending_response_max_age) ) {
+                entry = pending_responses.erase(entry);
+            } else {
+                ++entry;
+            }
+        }
     }
-    int instance_count = inv_instances_vector.size();
-    int current = random_number( 0, instance_count - 2 );
-    int instance_timeout = epoch() - 600;
-    for ( int retry = 0; retry < instance_count; ++retry ) {
-        if ( current >= instance_count - 1 ) {
-            current = 0;
+    pending_responses[url] = { host, latency_ms, now };
+}
+// Record held response in instance health, after caller has checked if body is valid.
+void record_response_health ( const std::string& url, bool valid ) {
+    pending_response response;
+    {
+        std::lock_guard<std::mutex> lock(instance_health_mutex);
+        auto found = pending_responses.find(url);
+        if ( found == pending_responses.end() ) {
+            return;
+        }
+        response = std::move(found->second);
+        pending_responses.erase(found);
+    }
+    record_instance_health(response.host, valid, response.latency_ms);
+}
+// Check if circuit breaker lets a request through to host
+bool instance_breaker_available ( const std::string& host ) {
+    std::lock_guard<std::mutex> lock(instance_health_mutex);
+    auto found = instance_health_map.find(host);
+    if (( found == instance_health_map.end() ) || ( found->second.breaker_state == 0 )) {
+        return true;
+    }
+    return epoch() >= found->second.retry_at;
+}
+// Mark request about to be sent to host, an open breaker past its backoff lets this one request through as probe.
+void instance_breaker_claim ( const std::string& host ) {
+    std::lock_guard<std::mutex> lock(instance_health_mutex);
+    auto found = instance_health_map.find(host);
+    if (( found != instance_health_map.end() ) && ( found->second.breaker_state != 0 ) && ( epoch() >= found->second.retry_at )) {
+        found->second.breaker_state = 2;
+        found->second.retry_at = epoch() + breaker_probe_timeout;
+    }
+}
+// Amount of instances with open or half-open circuit breaker
+int instance_breakers_open () {
+    std::lock_guard<std::mutex> lock(instance_health_mutex);
+    int open = 0;
+    for ( const auto& entry : instance_health_map ) {
+        if ( entry.second.breaker_state != 0 ) {
+            ++open;
+        }
+    }
+    return open;
+}
+// Expected cost of request to instance, lower is better. Unmeasured instances use 90 day uptime from instance list.
+double instance_score ( const int instance ) {
+    double latency_ms = instance_unmeasured_latency_ms;
+    double success = std::max(inv_instances_vector[instance].health, 50) / 100.0;
+    {
+        std::lock_guard<std::mutex> lock(instance_health_mutex);
+        auto found = instance_health_map.find(inv_instances_vector[instance].name);
+        if (( found != instance_health_map.end() ) && ( found->second.samples != 0 )) {
+            latency_ms = found->second.latency_ms;
+            success = found->second.success;
         }
+    }
+    return latency_ms / std::max(success, 0.05); // Failing instances cost more, as requests must be retried elsewhere
+}
+// Get random instance, picking better of two random usable instances.
+std::pair<bool, int> get_random_instance () {
+    std::vector<int> usable;
+    int instance_timeout = epoch() - 600;
+    for ( int current = 0; current < inv_instances_vector.size(); ++current ) {
         if ( inv_instances_vector[current].last_get <= instance_timeout ) {
             if ( inv_instances_vector[current].enabled ) {
                 if ( inv_instances_vector[current].api_enabled ) {
-                    if ( ! inv_instances_vector[current].banned ) {
-                        return std::make_pair(true, current);
+                    if (( ! inv_instances_vector[current].banned ) && instance_breaker_available(inv_instances_vector[current].name)) {
+                        usable.push_back(current);
                     }
                 }
             }
         }
-        ++current;
     }
-    log("Found no appropriate instances!");
-    return std::make_pair(false, 0);
+    if ( usable.size() == 0 ) {
+        log("Found no appropriate instances!");
+        return std::make_pair(false, 0);
+    }
+    int chosen = usable[random_number(0, usable.size() - 1)];
+    if ( usable.size() != 1 ) {
+        int second = usable[random_number(0, usable.size() - 2)];
+        if ( second == chosen ) {
+            second = usable.back();
+        }
+        if ( instance_score(second) < instance_score(chosen) ) {
+            chosen = second;
+        }
+    }
+    instance_breaker_claim(inv_instances_vector[chosen].name);
+    return std::make_pair(true, chosen);
 }
 // Write Callback
 size_t WriteCallback(void *contents, size_t size, size_t nmemb, std::string *data) {
@@ -563,119 +1435,807 @@ size_t WriteCallback(void *contents, size_t size, size_t nmemb, std::string *dat
     data->append((char*)contents, total_size);
     return total_size;
 }
-// Curl
-std::pair<bool, std::string> fetch (const std::string& url) {
-    CURL *curl;
-    CURLcode res;
-    std::string output;
-    bool success = false;
-    int timeout_seconds = 5;
-
-    // init curl
-    curl = curl_easy_init();
-
-    if (curl) {
-        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-        // Set callback
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &output);
-        // Timeout
-        curl_easy_setopt(curl, CURLOPT_TIMEOUT, timeout_seconds);
-        // run request
-        res = curl_easy_perform(curl);
-        // Check for errors
-        std::string curl_error = curl_easy_strerror(res);
-        if (res != CURLE_OK) {
-            log("CURL failed: " + curl_error + ", URL: " + url, 3);
-            success = false;
-        } else {
-            success = true;
-        }
-        // Clean up
-        curl_easy_cleanup(curl);
-    } else {
-        log("Request failed! " + url, 3);
-        success = false;
+// Curl lock callbacks for shared DNS, TLS session and connection caches
+void curl_share_lock ( CURL *, curl_lock_data data, curl_lock_access, void * ) {
+    curl_share_mutex[data].lock();
+}
+void curl_share_unlock ( CURL *, curl_lock_data data, void * ) {
+    curl_share_mutex[data].unlock();
+}
+// Init curl and shared caches, must run before any thread calls fetch.
+bool init_curl () {
+    if ( curl_global_init(CURL_GLOBAL_DEFAULT) != CURLE_OK ) {
+        return false;
     }
-    return std::make_pair(success, output);
+    curl_share = curl_share_init();
+    if ( ! curl_share ) {
+        return false;
+    }
+    curl_share_setopt(curl_share, CURLSHOPT_LOCKFUNC, curl_share_lock);
+    curl_share_setopt(curl_share, CURLSHOPT_UNLOCKFUNC, curl_share_unlock);
+    curl_share_setopt(curl_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(curl_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    curl_share_setopt(curl_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+    return true;
 }
-// Instances json to variables in vector
-void parse_instances(const json& data) { // receives instances json output, and refreshes list of local instances.
-    inv_instances_vector.clear(); // clear instances vector
-    int inv_instances_vector_iteration = 0; // Instance vector iteration counter
-    for (const auto& entry : data) {
-        std::string headname;
-        std::string type;
-        bool enabled = true;
-
-        bool tmp_ratio_enabled = false;
-        std::string tmp_ratio;
-        int tmp_ratio_int;
-
-        headname = entry[0]; // Name
-        if (entry[1]["api"].is_null()) {
-            enabled = false;
-            log("Skipping non-API instance: " + headname);
-            continue;
+// Get host part of URL, "https://host/path" -> "host"
+std::string url_host ( const std::string& url ) {
+    size_t start = url.find("://");
+    start = ( start == std::string::npos ) ? 0 : start + 3;
+    size_t end = url.find('/', start);
+    return url.substr(start, end == std::string::npos ? std::string::npos : end - start);
+}
+// Take idle curl handle for host from pool, or create a new one.
+CURL *acquire_curl_handle ( const std::string& host ) {
+    {
+        std::lock_guard<std::mutex> lock(curl_pool_mutex);
+        auto pool = curl_handle_pool.find(host);
+        if ( pool != curl_handle_pool.end() && pool->second.size() != 0 ) {
+            CURL *curl = pool->second.back();
+            pool->second.pop_back();
+            return curl;
         }
-        type = entry[1]["type"]; // Type, "HTTPS"
-
-        // Extracting variables
-        bool api_enabled = entry[1]["api"];
-        if (!entry[1]["monitor"].is_null()) {
-            tmp_ratio = entry[1]["monitor"]["90dRatio"]["ratio"]; // Ratio, uptime last 90 Days as integer.
-            tmp_ratio_int = std::stoi(tmp_ratio);
-            tmp_ratio_enabled = true;
+    }
+    CURL *curl = curl_easy_init();
+    if ( curl ) {
+        if ( curl_share ) {
+            curl_easy_setopt(curl, CURLOPT_SHARE, curl_share);
         }
-        std::string uri = entry[1]["uri"]; // Instance URL 
-        std::string region = entry[1]["region"]; // Instance Region, (US, DE, NO, etc...)
-
-        if ( enabled ) { // add entry to instance list
-            log("Adding instance: " + headname);
-            inv_instances_vector.push_back(inv_instances());
-            inv_instances_vector[inv_instances_vector_iteration].enabled = enabled;
-            inv_instances_vector[inv_instances_vector_iteration].api_enabled = api_enabled;
-            inv_instances_vector[inv_instances_vector_iteration].name = headname;
-            inv_instances_vector[inv_instances_vector_iteration].URL = uri;
-            inv_instances_vector[inv_instances_vector_iteration].type = type;
-            inv_instances_vector[inv_instances_vector_iteration].region = region;
-            if ( tmp_ratio_enabled ) {
-                inv_instances_vector[inv_instances_vector_iteration].health = tmp_ratio_int;
-            } else {
-                inv_instances_vector[inv_instances_vector_iteration].health = 0;
+        curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    }
+    return curl;
+}
+// Return curl handle to pool for host, keeping its connection open for next request.
+void release_curl_handle ( const std::string& host, CURL *curl ) {
+    {
+        std::lock_guard<std::mutex> lock(curl_pool_mutex);
+        std::vector<CURL*>& pool = curl_handle_pool[host];
+        if ( pool.size() < curl_pool_max_idle ) {
+            pool.push_back(curl);
+            return;
+        }
+    }
+    curl_easy_cleanup(curl);
+}
+// Set request options on pooled curl handle, response body is written to output.
+void setup_curl_request ( CURL *curl, const std::string& url, std::string *output ) {
+    int timeout_seconds = 5;
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    // Set callback
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, output);
+    // Timeout
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, timeout_seconds);
+}
+// Remember latency of successful request for hedge delay
+void record_request_latency ( int latency_ms ) {
+    std::lock_guard<std::mutex> lock(request_latency_mutex);
+    request_latency_ring[request_latency_count % 64] = latency_ms;
+    ++request_latency_count;
+}
+// Delay before hedging, 95th percentile of recent request latencies.
+int hedge_delay_ms () {
+    std::vector<int> latencies;
+    {
+        std::lock_guard<std::mutex> lock(request_latency_mutex);
+        if ( request_latency_count < 8 ) {
+            return hedge_delay_default_ms;
+        }
+        latencies.assign(request_latency_ring, request_latency_ring + std::min(request_latency_count, 64));
+    }
+    size_t p95 = latencies.size() * 95 / 100;
+    std::nth_element(latencies.begin(), latencies.begin() + p95, latencies.end());
+    return std::clamp(latencies[p95], hedge_delay_min_ms, hedge_delay_max_ms);
+}
+// Take one hedge from budget, budget refills as hedgeable requests are made.
+bool take_hedge_budget () {
+    int budget = hedge_budget;
+    while ( budget >= 10 ) {
+        if ( hedge_budget.compare_exchange_weak(budget, budget - 10) ) {
+            return true;
+        }
+    }
+    return false;
+}
+// Check result of finished request, count connections and return handle to pool.
+bool finish_curl_request ( CURL *curl, CURLcode res, const std::string& host, const std::string& url ) {
+    bool success;
+    // Check for errors
+    if ( res == CURLE_ABORTED_BY_CALLBACK ) { // Cancelled, not the instance's fault
+        log_debug("Request cancelled: {}", url);
+        release_curl_handle(host, curl);
+        return false;
+    }
+    if (res != CURLE_OK) {
+        std::string curl_error = curl_easy_strerror(res);
+        log_format(3, "CURL failed: {}, URL: {}", curl_error, url);
+        success = false;
+    } else {
+        success = true;
+    }
+    // Instance health, server errors count as failures. Other responses are recorded once caller has checked body.
+    long response_code = 0;
+    curl_off_t total_time_us = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total_time_us);
+    if ( success && ( response_code < 500 ) && ( response_code != 429 )) {
+        hold_response_health(url, host, total_time_us / 1000.0);
+    } else {
+        record_instance_health(host, false, total_time_us / 1000.0);
+    }
+    if ( success ) {
+        record_request_latency(total_time_us / 1000);
+    }
+    // Count new and reused connections
+    long new_connections = 0;
+    curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &new_connections);
+    if ( new_connections > 0 ) {
+        fetch_connections_new += new_connections;
+    } else if ( success ) {
+        ++fetch_connections_reused;
+    }
+    // Return handle to pool
+    release_curl_handle(host, curl);
+    return success;
+}
+// Check if cancellable request should stop
+bool fetch_cancelled ( const fetch_cancel& cancel ) {
+    return ( *cancel.generation != cancel.expected ) || ( std::chrono::steady_clock::now() >= cancel.deadline );
+}
+// Curl progress callback, non zero return aborts transfer.
+int fetch_cancel_callback ( void *data, curl_off_t, curl_off_t, curl_off_t, curl_off_t ) {
+    return fetch_cancelled(*(const fetch_cancel *)data) ? 1 : 0;
+}
+// Curl
+std::pair<bool, std::string> fetch ( const std::string& url, const fetch_cancel *cancel = nullptr ) {
+    CURL *curl;
+    std::string output;
+    bool success = false;
+    std::string host = url_host(url);
+
+    // get pooled curl handle
+    curl = acquire_curl_handle(host);
+
+    if (curl) {
+        setup_curl_request(curl, url, &output);
+        if ( cancel ) {
+            long remaining_ms = std::chrono::duration_cast<std::chrono::milliseconds>(cancel->deadline - std::chrono::steady_clock::now()).count();
+            curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, std::clamp(remaining_ms, 1L, 5000L));
+            curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, fetch_cancel_callback);
+            curl_easy_setopt(curl, CURLOPT_XFERINFODATA, cancel);
+            curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+        }
+        // run request
+        CURLcode res = curl_easy_perform(curl);
+        if ( cancel ) { // Handle goes back to pool
+            curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 1L);
+            curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, NULL);
+            curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, 0L);
+        }
+        success = finish_curl_request(curl, res, host, url);
+    } else {
+        log_format(3, "Request failed! {}", url);
+        success = false;
+    }
+    return std::make_pair(success, output);
+}
+// Fetch url, also sending a hedge if url has not answered within hedge delay or failed. choose_hedge is called only then,
+// and returns hedge URL or empty if there is none. First successful response wins, and the other request is cancelled.
+// winner is set to 0 for url and 1 for hedge.
+std::pair<bool, std::string> fetch_hedged ( const std::string& url, const std::function<std::string()>& choose_hedge, int& winner ) {
+    winner = 0;
+    if ( hedge_budget < hedge_budget_max ) {
+        ++hedge_budget;
+    }
+    CURLM *multi = curl_multi_init();
+    if ( ! multi ) {
+        return fetch(url);
+    }
+
+    struct attempt {
+        const std::string *url;
+        std::string host;
+        std::string body;
+        CURL *curl = nullptr;
+        bool running = false;
+    };
+    std::string hedge_url;
+    attempt attempts[2];
+    attempts[0].url = &url;
+    attempts[1].url = &hedge_url;
+    auto start_attempt = [&]( int i ) {
+        if ( i == 1 ) {
+            hedge_url = choose_hedge();
+            if ( hedge_url.empty() ) {
+                return false;
             }
+        }
+        attempts[i].host = url_host(*attempts[i].url);
+        attempts[i].curl = acquire_curl_handle(attempts[i].host);
+        if ( ! attempts[i].curl ) {
+            log_format(3, "Request failed! {}", *attempts[i].url);
+            return false;
+        }
+        setup_curl_request(attempts[i].curl, *attempts[i].url, &attempts[i].body);
+        curl_multi_add_handle(multi, attempts[i].curl);
+        attempts[i].running = true;
+        return true;
+    };
+
+    std::pair<bool, std::string> result(false, "");
+    auto started = std::chrono::steady_clock::now();
+    int delay_ms = hedge_delay_ms();
+    bool hedged = false;
+    bool hedge_won = false;     // Hedge answered while url was still in flight
+    int running = start_attempt(0) ? 1 : 0;
 
-            ++inv_instances_vector_iteration;
+    while ( true ) {
+        if (( ! hedged ) && ( running == 0 )) { // Primary failed, use hedge as retry without spending budget.
+            hedged = true;
+            running += start_attempt(1) ? 1 : 0;
+        }
+        if ( running == 0 ) {
+            break;
+        }
+        int still_running = 0;
+        curl_multi_perform(multi, &still_running);
+
+        CURLMsg *message;
+        int messages_left;
+        while (( message = curl_multi_info_read(multi, &messages_left) )) {
+            if ( message->msg != CURLMSG_DONE ) {
+                continue;
+            }
+            int i = ( message->easy_handle == attempts[0].curl ) ? 0 : 1;
+            CURLcode res = message->data.result;
+            curl_multi_remove_handle(multi, attempts[i].curl);
+            attempts[i].running = false;
+            --running;
+            bool success = finish_curl_request(attempts[i].curl, res, attempts[i].host, *attempts[i].url);
+            if ( success && ( ! result.first )) {
+                result = std::make_pair(true, std::move(attempts[i].body));
+                winner = i;
+                hedge_won = ( i == 1 ) && attempts[0].running;
+            }
+        }
+        if ( result.first ) {
+            break;
+        }
+
+        int elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started).count();
+        if (( ! hedged ) && ( elapsed_ms >= delay_ms )) {
+            hedged = true;
+            if ( take_hedge_budget() && start_attempt(1) ) {
+                ++running;
+                ++fetch_hedges_sent;
+                log_debug("Hedging slow request after {} ms: {}", elapsed_ms, hedge_url);
+            }
+        }
+        if ( still_running != 0 ) {
+            curl_multi_poll(multi, NULL, 0, hedged ? 1000 : std::max(delay_ms - elapsed_ms, 1), NULL);
         }
     }
-    if ( inv_instances_vector.size() >= 1 ) {
-        log("Successfully added " + to_string_int(inv_instances_vector.size()) + " Instances.", 1);
+
+    // Cancel loser, its connection is mid transfer and cannot be reused.
+    for ( attempt& loser : attempts ) {
+        if ( loser.running ) {
+            curl_multi_remove_handle(multi, loser.curl);
+            curl_easy_cleanup(loser.curl);
+        }
+    }
+    curl_multi_cleanup(multi);
+    if ( hedge_won ) { // Not when hedge only retried a failed request
+        ++fetch_hedges_won;
+    }
+    return result;
+}
+// Take parse task, own queue first, then steal from others. Index -1 only steals.
+bool parse_take ( int index, std::function<void()>& task ) {
+    if ( index != -1 ) {
+        std::lock_guard<std::mutex> lock(parse_queues[index].mutex);
+        if ( parse_queues[index].tasks.size() != 0 ) {
+            task = std::move(parse_queues[index].tasks.back());
+            parse_queues[index].tasks.pop_back();
+            --parse_queued;
+            return true;
+        }
+    }
+    for ( int offset = 1; offset <= parse_threads; ++offset ) {
+        int victim = ( index + offset + parse_threads ) % parse_threads;
+        if ( victim == index ) {
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(parse_queues[victim].mutex);
+        if ( parse_queues[victim].tasks.size() != 0 ) {
+            task = std::move(parse_queues[victim].tasks.front());
+            parse_queues[victim].tasks.pop_front();
+            --parse_queued;
+            ++parse_tasks_stolen;
+            return true;
+        }
+    }
+    return false;
+}
+// Parse thread, runs tasks from own queue and steals when empty.
+void THREAD_parse ( int index ) {
+    parse_thread_index = index;
+    std::function<void()> task;
+    while ( ! collapse_threads ) {
+        if ( parse_take(index, task) ) {
+            task();
+            task = nullptr;
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(parse_idle_mutex);
+        parse_idle_cv.wait(lock, []{ return ( parse_queued != 0 ) || collapse_threads; });
+    }
+}
+// Start parse threads, one per core
+void start_parse_pool () {
+    parse_threads = std::clamp((int)std::thread::hardware_concurrency(), 1, parse_max_threads);
+    for ( int index = 0; index < parse_threads; ++index ) {
+        std::thread parse_thread(THREAD_parse, index);
+        parse_thread.detach();
+    }
+    log_debug("Started {} parse threads.", parse_threads);
+}
+// Wake idle parse threads so they see collapse_threads and exit
+void stop_parse_pool () {
+    {
+        std::lock_guard<std::mutex> lock(parse_idle_mutex);
+    }
+    parse_idle_cv.notify_all();
+}
+// Queue parse task in group. Tasks from parse threads go to own queue, others are spread over all queues.
+void parse_submit ( parse_group& group, std::function<void()> task ) {
+    {
+        std::lock_guard<std::mutex> lock(group.mutex);
+        ++group.pending;
+    }
+    std::function<void()> counted = [&group, task = std::move(task)]{
+        task();
+        ++parse_tasks_done;
+        std::lock_guard<std::mutex> lock(group.mutex);
+        if ( --group.pending == 0 ) {
+            group.cv.notify_all();
+        }
+    };
+    if ( parse_threads == 0 ) {
+        counted();
+        return;
+    }
+    int index = ( parse_thread_index != -1 ) ? parse_thread_index : parse_next_queue++ % parse_threads;
+    {
+        std::lock_guard<std::mutex> lock(parse_queues[index].mutex);
+        parse_queues[index].tasks.push_back(std::move(counted));
+        ++parse_queued;
+    }
+    {
+        std::lock_guard<std::mutex> lock(parse_idle_mutex); // Pairs with idle wait, so wake is not lost
+    }
+    parse_idle_cv.notify_one();
+}
+// Wait for all tasks in group, helping with queued tasks meanwhile.
+void parse_wait ( parse_group& group ) {
+    std::function<void()> task;
+    while ( true ) {
+        {
+            std::lock_guard<std::mutex> lock(group.mutex);
+            if ( group.pending == 0 ) {
+                return;
+            }
+        }
+        if ( parse_take(parse_thread_index, task) ) {
+            task();
+            task = nullptr;
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(group.mutex);
+        group.cv.wait_for(lock, std::chrono::milliseconds(10), [&]{ return group.pending == 0; });
+    }
+}
+// Run many requests concurrently with curl multi, keeping up to max_in_flight requests running.
+// Callbacks run on the calling thread as each request completes. Requests with on_parse are parsed on parse pool,
+// and their on_complete runs in request order, as soon as all earlier requests are done.
+void fetch_many ( const std::vector<fetch_request>& requests, int max_in_flight = fetch_max_in_flight ) {
+    struct transfer {
+        CURL *curl;
+        std::string host;
+        std::string body;
+        size_t request;
+    };
+    struct response {
+        bool success = false;
+        std::string body;
+        std::atomic<bool> ready{false};     // Fetched, and parsed if request has on_parse
+    };
+
+    std::vector<response> responses(requests.size());
+    size_t next_delivery = 0;
+    parse_group group;
+    CURLM *multi = curl_multi_init();
+
+    // Complete request, or hand body to parse pool
+    auto finish = [&]( size_t i, bool success, std::string body ) {
+        const fetch_request& request = requests[i];
+        if ( ! request.on_parse ) {
+            request.on_complete(success, body);
+            responses[i].ready = true;
+            return;
+        }
+        responses[i].success = success;
+        responses[i].body = std::move(body);
+        parse_submit(group, [&request, &responses, i, multi]{
+            request.on_parse(responses[i].success, responses[i].body);
+            responses[i].ready = true;
+            if ( multi ) {
+                curl_multi_wakeup(multi); // Deliver without waiting for next transfer
+            }
+        });
+    };
+    // Merge parsed responses in request order, for deterministic lists
+    auto deliver = [&]() {
+        while (( next_delivery < requests.size() ) && responses[next_delivery].ready ) {
+            const fetch_request& request = requests[next_delivery];
+            if ( request.on_parse ) {
+                request.on_complete(responses[next_delivery].success, responses[next_delivery].body);
+                std::string().swap(responses[next_delivery].body);
+            }
+            ++next_delivery;
+        }
+    };
+
+    if ( ! multi ) {
+        log("Unable to init curl multi, fetching serially.", 3);
+        for ( size_t i = 0; i < requests.size(); ++i ) {
+            auto result = fetch(requests[i].url);
+            finish(i, result.first, std::move(result.second));
+        }
+        parse_wait(group);
+        deliver();
+        return;
+    }
+
+    std::list<transfer> running; // list, so body pointers handed to curl stay valid.
+    size_t next_request = 0;
+    int still_running = 0;
+
+    while ( true ) {
+        // Fill free slots with waiting requests.
+        while (( running.size() < (size_t)max_in_flight ) && ( next_request < requests.size() )) {
+            const fetch_request& request = requests[next_request];
+            std::string host = url_host(request.url);
+            CURL *curl = acquire_curl_handle(host);
+            if ( ! curl ) {
+                log_format(3, "Request failed! {}", request.url);
+                finish(next_request, false, "");
+                ++next_request;
+                continue;
+            }
+            running.push_back({ curl, host, "", next_request });
+            setup_curl_request(curl, request.url, &running.back().body);
+            curl_easy_setopt(curl, CURLOPT_PRIVATE, &running.back());
+            curl_multi_add_handle(multi, curl);
+            ++next_request;
+        }
+        deliver();
+        if ( running.size() == 0 ) {
+            break;
+        }
+
+        curl_multi_perform(multi, &still_running);
+
+        // Hand over finished requests.
+        CURLMsg *message;
+        int messages_left;
+        while (( message = curl_multi_info_read(multi, &messages_left) )) {
+            if ( message->msg != CURLMSG_DONE ) {
+                continue;
+            }
+            transfer *done;
+            curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, (char **)&done);
+            CURLcode res = message->data.result;
+            curl_multi_remove_handle(multi, done->curl);
+            bool success = finish_curl_request(done->curl, res, done->host, requests[done->request].url);
+            finish(done->request, success, std::move(done->body));
+            running.remove_if([done](const transfer& t) { return &t == done; });
+        }
+
+        if ( still_running != 0 ) {
+            curl_multi_poll(multi, NULL, 0, 1000, NULL);
+        }
+    }
+    parse_wait(group); // Before cleanup, parse tasks wake multi handle
+    deliver();
+    curl_multi_cleanup(multi);
+}
+// Video fields read from list responses, everything else in the response is skipped while parsing.
+struct video_list_item {
+    std::string videoid;
+    std::string title;
+    std::string author;
+    std::string author_id;
+    int length = 0;
+    int published = 0;
+    int viewcount = 0;
+    bool unsupported = false;   // Live, premium or upcoming
+};
+// SAX handler extracting video list from popular, search or channel response without building json DOM.
+class video_list_sax : public nlohmann::json_sax<json> {
+public:
+    std::vector<video_list_item> items;
+    bool found_list = false;    // false if response had no list, ex. error object
+    std::string error;
+
+    // List is top level array if list_key is empty, otherwise array under list_key in top level object.
+    explicit video_list_sax ( const std::string& list_key = "" ) : list_key(list_key) {}
+
+    bool start_array ( std::size_t ) override {
+        ++depth;
+        if (( list_depth == -1 ) && ( ! found_list )) {
+            if (( list_key.empty() && depth == 1 ) || (( ! list_key.empty() ) && depth == 2 && current_key == list_key )) {
+                list_depth = depth;
+                found_list = true;
+            }
+        }
+        return true;
+    }
+    bool end_array () override {
+        if ( depth == list_depth ) {
+            list_depth = -1;
+        }
+        --depth;
+        return true;
+    }
+    bool start_object ( std::size_t ) override {
+        ++depth;
+        if (( list_depth != -1 ) && ( depth == list_depth + 1 )) {
+            items.emplace_back();
+        }
+        return true;
+    }
+    bool end_object () override {
+        --depth;
+        return true;
+    }
+    bool key ( string_t& value ) override {
+        if (( depth == 1 ) || in_item() ) {
+            current_key = value;
+        }
+        return true;
+    }
+    bool string ( string_t& value ) override {
+        if ( in_item() ) {
+            video_list_item& item = items.back();
+            if ( current_key == "videoId" ) { item.videoid = std::move(value); }
+            else if ( current_key == "title" ) { item.title = std::move(value); }
+            else if ( current_key == "author" ) { item.author = std::move(value); }
+            else if ( current_key == "authorId" ) { item.author_id = std::move(value); }
+        }
+        return true;
+    }
+    bool number_integer ( number_integer_t value ) override {
+        if ( in_item() ) {
+            video_list_item& item = items.back();
+            if ( current_key == "lengthSeconds" ) { item.length = value; }
+            else if ( current_key == "published" ) { item.published = value; }
+            else if ( current_key == "viewCount" ) { item.viewcount = value; }
+        }
+        return true;
+    }
+    bool number_unsigned ( number_unsigned_t value ) override {
+        return number_integer(value);
+    }
+    bool number_float ( number_float_t value, const string_t& ) override {
+        return number_integer(value);
+    }
+    bool boolean ( bool value ) override {
+        if ( in_item() && value ) {
+            if (( current_key == "liveNow" ) || ( current_key == "premium" ) || ( current_key == "isUpcoming" )) {
+                items.back().unsupported = true;
+            }
+        }
+        return true;
+    }
+    bool null () override { return true; }
+    bool binary ( binary_t& ) override { return true; }
+    bool parse_error ( std::size_t, const std::string&, const nlohmann::detail::exception& e ) override {
+        error = e.what();
+        return false;
+    }
+private:
+    std::string list_key;
+    std::string current_key;    // Last key in top level object or current item
+    int depth = 0;              // Current nesting of arrays and objects
+    int list_depth = -1;        // Depth of video list array while inside it
+
+    bool in_item () const {
+        return ( list_depth != -1 ) && ( depth == list_depth + 1 );
+    }
+};
+// Instance fields read from instances response
+struct instance_list_item {
+    std::string name;
+    std::string type;
+    std::string uri;
+    std::string region;
+    bool api = false;
+    bool api_null = true;       // "api" missing or null, instance is skipped
+    std::string ratio;          // 90 day uptime ratio, empty if instance is not monitored
+};
+// SAX handler extracting instance list, [[name, {type, uri, region, api, monitor: {90dRatio: {ratio}}}], ...]
+class instance_list_sax : public nlohmann::json_sax<json> {
+public:
+    std::vector<instance_list_item> items;
+    std::string error;
+
+    bool start_array ( std::size_t ) override {
+        ++depth;
+        if ( depth == 2 ) {
+            items.emplace_back();
+        }
+        return true;
+    }
+    bool end_array () override {
+        --depth;
+        return true;
+    }
+    bool start_object ( std::size_t ) override {
+        ++depth;
+        keys[std::min(depth, 5)].clear();
+        return true;
+    }
+    bool end_object () override {
+        --depth;
+        return true;
+    }
+    bool key ( string_t& value ) override {
+        if ( depth <= 5 ) {
+            keys[depth] = value;
+        }
+        return true;
+    }
+    bool string ( string_t& value ) override {
+        if ( items.empty() ) {
+            return true;
+        }
+        instance_list_item& item = items.back();
+        if ( depth == 2 ) { item.name = std::move(value); }
+        else if ( depth == 3 ) {
+            if ( keys[3] == "type" ) { item.type = std::move(value); }
+            else if ( keys[3] == "uri" ) { item.uri = std::move(value); }
+            else if ( keys[3] == "region" ) { item.region = std::move(value); }
+        } else if (( depth == 5 ) && ( keys[3] == "monitor" ) && ( keys[4] == "90dRatio" ) && ( keys[5] == "ratio" )) {
+            item.ratio = std::move(value);
+        }
+        return true;
+    }
+    bool boolean ( bool value ) override {
+        if (( ! items.empty() ) && ( depth == 3 ) && ( keys[3] == "api" )) {
+            items.back().api = value;
+            items.back().api_null = false;
+        }
+        return true;
+    }
+    bool number_integer ( number_integer_t ) override { return true; }
+    bool number_unsigned ( number_unsigned_t ) override { return true; }
+    bool number_float ( number_float_t, const string_t& ) override { return true; }
+    bool null () override { return true; }
+    bool binary ( binary_t& ) override { return true; }
+    bool parse_error ( std::size_t, const std::string&, const nlohmann::detail::exception& e ) override {
+        error = e.what();
+        return false;
+    }
+private:
+    int depth = 0;
+    std::string keys[6];        // Last key at each object depth
+};
+// Video list response parsed on parse pool, waiting to be merged into video cache.
+struct parsed_video_list {
+    video_list_sax handler;
+    bool parsed = false;        // Fetched and valid JSON
+
+    parsed_video_list ( const std::string& list_key = "" ) : handler(list_key) {}
+    // Parse response body, runs without cache_mutex.
+    void parse ( bool success, const std::string& body ) {
+        parsed = success && json::sax_parse(body, &handler);
+    }
+};
+// Store video from list response in main video cache, returns handle.
+int store_video_list_item ( const video_list_item& item ) {
+    auto video_in_list = get_videoid_from_vector(item.videoid);
+    int video = video_in_list.first ? video_in_list.second : add_video_to_vector(item.videoid);
+    inv_videos_vector[video].title = item.title;
+    inv_videos_vector[video].author = item.author;
+    set_video_author(video, item.author_id);
+    inv_videos_vector[video].lengthseconds = item.length;
+    inv_videos_vector[video].published = item.published;
+    inv_videos_vector[video].viewcount = item.viewcount;
+    inv_videos_vector[video].last_updated = epoch();
+    return video;
+}
+// Instances list to variables in vector
+void parse_instances ( const std::vector<instance_list_item>& data ) { // receives parsed instances, and refreshes list of local instances.
+    // Instances keep their position in vector, as running jobs hold instance numbers. Instances gone from list are disabled.
+    std::vector<bool> listed(inv_instances_vector.size(), false);
+    int listed_count = 0;
+    for ( const instance_list_item& entry : data ) {
+        if ( entry.api_null ) {
+            log_debug("Skipping non-API instance: {}", entry.name);
+            continue;
+        }
+        int health = 0;
+        if ( ! entry.ratio.empty() ) {
+            try {
+                health = std::stoi(entry.ratio); // Ratio, uptime last 90 Days as integer.
+            } catch (const std::exception& e) {
+                health = 0;
+            }
+        }
+        int position = -1;
+        for ( int i_instance = 0; i_instance < inv_instances_vector.size(); ++i_instance ) {
+            if ( inv_instances_vector[i_instance].name == entry.name ) {
+                position = i_instance;
+                break;
+            }
+        }
+        if ( position == -1 ) {
+            log_debug("Adding instance: {}", entry.name);
+            position = inv_instances_vector.size();
+            inv_instances_vector.push_back(inv_instances());
+            inv_instances_vector[position].last_update_popular = 0;
+            listed.push_back(false);
+        }
+        listed[position] = true;
+        ++listed_count;
+        inv_instances& instance = inv_instances_vector[position];
+        instance.updated = false; // Apply bans again
+        instance.enabled = true;
+        instance.api_enabled = entry.api;
+        instance.name = entry.name;
+        instance.URL = entry.uri;
+        instance.type = entry.type;             // Type, "HTTPS"
+        instance.region = entry.region;         // Instance Region, (US, DE, NO, etc...)
+        instance.health = health;
+    }
+    for ( int i_instance = 0; i_instance < listed.size(); ++i_instance ) {
+        if ( ! listed[i_instance] ) {
+            inv_instances_vector[i_instance].enabled = false;
+        }
+    }
+    if ( listed_count >= 1 ) {
+        log_format(1, "Successfully added {} Instances.", listed_count);
         local_instances_updated = true;
     } else {
         log("Unable to update local instance list!", 4);
     }
 }
 // Update local instance list
-void update_instances () {
+bool update_instances () {
     auto result = fetch(URL_instances);
+    bool updated = false;
     if ( result.first ) {
-        try {
-            json data = json::parse(result.second);
-            parse_instances(data);
-        } catch (const std::exception& e) {
-            std::stringstream parse_result;
-            parse_result << e.what();
-            log("Error parsing JSON: " + parse_result.str(), 4);
+        instance_list_sax handler;
+        bool parsed = json::sax_parse(result.second, &handler);
+        record_response_health(URL_instances, parsed);
+        if ( parsed ) {
+            std::unique_lock<std::shared_mutex> lock(cache_mutex);
+            parse_instances(handler.items);
+            updated = inv_instances_vector.size() != 0;
+        } else {
+            log_format(4, "Error parsing JSON: {}", handler.error);
         }
-        update_ui = true;
+        request_ui_update();
     } else {
-        log("Curl is unable to contact API: " + URL_instances, 4);
+        log_format(4, "Curl is unable to contact API: {}", URL_instances);
     }
+    return updated;
 }
 // Update instance information from file and variables
 void update_instance_info (const int instance) {
     bool skip = false;
-    log("Updating instance information for: " + inv_instances_vector[instance].name);
+    log_debug("Updating instance information for: {}", inv_instances_vector[instance].name);
     // Check if instance can be skipped
     if ( inv_instances_vector[instance].enabled == false ) { skip = true; }
     if ( inv_instances_vector[instance].api_enabled == false ) { skip = true; }
@@ -683,7 +2243,7 @@ void update_instance_info (const int instance) {
     // Update information:
     if ( ! skip ) {
         if ( find_string_in_file(config_file_banned_instances, inv_instances_vector[instance].name) ) {
-            log("Banning instance: " + inv_instances_vector[instance].name);
+            log_debug("Banning instance: {}", inv_instances_vector[instance].name);
             inv_instances_vector[instance].banned = true;
         }
         if ( ! ( inv_instances_vector[instance].type == "https" )) {
@@ -693,540 +2253,1172 @@ void update_instance_info (const int instance) {
 
     inv_instances_vector[instance].updated = true;
 }
-// Update video Information
-void update_video_info ( const int videonum ) { // https://instance.name/api/v1/videos/aqz-KE-bpKQ?&fields=title,description,published,viewCount,author,authorId,lengthSeconds
-    std::string videoid = inv_videos_vector[videonum].URL;
-    log("Running update for video: " + videoid);
-    auto random_instance = get_random_instance();
-    if ( ! random_instance.first ) {
-        log("Unable to retrieve instance!", 4);
+// Build API request URL for instance, asking only for fields used by endpoint parser. Ex. https://instance.name/api/v1/popular?fields=videoId,title
+std::string api_url ( const int instance, const api_endpoint endpoint, const std::string& path, const std::string& query = "" ) {
+    std::string url = "https://" + inv_instances_vector[instance].name + "/api/v1/" + path;
+    if ( ! query.empty() ) {
+        url += "?" + query;
+    }
+    if ( debug && ( ! api_endpoints[endpoint].baseline_claimed.exchange(true) )) {
+        return url; // Unprojected sample, to compare sizes with. Only in verbose runs, as it downloads the full response.
+    }
+    url += query.empty() ? "?fields=" : "&fields=";
+    url += api_endpoints[endpoint].fields;
+    return url;
+}
+// Count response size for endpoint. A failed baseline sample is retried with next request.
+void api_record_response ( const api_endpoint endpoint, const std::string& url, bool success, size_t bytes ) {
+    api_endpoint_info& info = api_endpoints[endpoint];
+    bool projected = url.find("fields=") != std::string::npos;
+    if ( ! success ) {
+        if ( ! projected ) {
+            info.baseline_claimed = false;
+        }
         return;
     }
-    std::string instance = inv_instances_vector[random_instance.second].name;
-    std::stringstream video_url;
-    video_url << "https://" << instance << "/api/v1/videos/" << videoid << "?&fields=title,description,published,viewCount,author,authorId,lengthSeconds";
-    auto result = fetch(video_url.str());
-    while ( true ) { // get json output
-        if ( result.first ) {
-            try {
-                json data = json::parse(result.second);
-
-                if ( data.contains("error") ) {
-                    std::string errorMessage = data["error"].get<std::string>();
-                    log("Video: " + videoid + " Returned Error: " + errorMessage, 2);
-                    if ( inv_videos_vector[videonum].retry >= 5 ) {
-                        inv_videos_vector[videonum].normal_video = false;
-                        log("Blacklisted video: " + videoid, 2);
-                        break;
-                    } else {
-                        ++inv_videos_vector[videonum].retry;
-                        log("Retrying video: " + videoid);
-                    }
-                } else {
-                    inv_videos_vector[videonum].title = data["title"].get<std::string>();
-                    inv_videos_vector[videonum].description = data["description"].get<std::string>();
-                    inv_videos_vector[videonum].published = data["published"].get<int>();
-                    inv_videos_vector[videonum].viewcount = data["viewCount"].get<int>();
-                    inv_videos_vector[videonum].author = data["author"].get<std::string>();
-                    inv_videos_vector[videonum].author_id = data["authorId"].get<std::string>();
-                    inv_videos_vector[videonum].lengthseconds = data["lengthSeconds"].get<int>();
-                    inv_videos_vector[videonum].manual_update = true;
-                    inv_videos_vector[videonum].priority_update = false;
-                    log("Video details updated for: " + inv_videos_vector[videonum].URL + " With Instance: " + instance, 1);
-                    if ( popup_box ) { if ( current_selected_video == videonum ) { update_ui = true; }}
-                    break;
-                }
-            } catch (const std::exception& e) {
-                std::stringstream parse_result;
-                parse_result << e.what();
-                log("Error parsing JSON: " + parse_result.str(), 2);
-                inv_instances_vector[random_instance.second].last_get = epoch();
-                log("Disabling instance for 10 minutes: " + inv_instances_vector[random_instance.second].name);
+    if ( projected ) {
+        info.projected_bytes += bytes;
+        ++info.projected_requests;
+    } else {
+        info.baseline_bytes += bytes;
+        ++info.baseline_requests;
+    }
+}
+// Estimated bytes saved by projection for endpoint, from average unprojected response size. -1 if no baseline yet.
+long long api_bytes_saved ( const api_endpoint endpoint ) {
+    const api_endpoint_info& info = api_endpoints[endpoint];
+    if ( info.baseline_requests == 0 ) {
+        return -1;
+    }
+    return info.baseline_bytes / info.baseline_requests * info.projected_requests - info.projected_bytes;
+}
+// Video information URL for instance
+std::string video_info_url ( const int instance, const std::string& videoid ) { // https://instance.name/api/v1/videos/aqz-KE-bpKQ?fields=title,description,published,viewCount,author,authorId,lengthSeconds
+    return api_url(instance, api_video_info, "videos/" + videoid);
+}
+// Video information response parsed without cache_mutex.
+struct parsed_video_info {
+    json data;
+    std::string error;          // Parse error, empty if data is valid
+};
+// Parse video information response body, runs without cache_mutex.
+parsed_video_info parse_video_info_body ( const std::string& body ) {
+    parsed_video_info parsed;
+    try {
+        parsed.data = json::parse(body);
+    } catch (const std::exception& e) {
+        parsed.error = e.what();
+    }
+    return parsed;
+}
+// Apply parsed video information. Returns true when done with video, false if it should be retried with another instance.
+bool parse_video_info ( const int videonum, const int instance, const std::string& url, const parsed_video_info& parsed ) {
+    std::string videoid = inv_videos_vector[videonum].URL;
+    try {
+        if ( ! parsed.error.empty() ) {
+            throw std::runtime_error(parsed.error);
+        }
+        const json& data = parsed.data;
+
+        if ( data.contains("error") ) {
+            std::string errorMessage = data["error"].get<std::string>();
+            log_format(2, "Video: {} Returned Error: {}", videoid, errorMessage);
+            record_response_health(url, true); // Valid answer from instance
+            if ( inv_videos_vector[videonum].retry >= 5 ) {
+                inv_videos_vector[videonum].normal_video = false;
+                log_format(2, "Blacklisted video: {}", videoid);
+                return true;
+            } else {
+                ++inv_videos_vector[videonum].retry;
+                log_debug("Retrying video: {}", videoid);
+                return false;
             }
         } else {
-            log("Curl is unable to contact instance's API: " + video_url.str(), 2);
-        }
-        random_instance = get_random_instance();
-        instance = inv_instances_vector[random_instance.second].name;
-        video_url << "https://" << instance << "/api/v1/videos/" << videoid << "?&fields=title,description,published,viewCount,author,authorId,lengthSeconds";
-        result = fetch(video_url.str());
-        video_url.str(std::string());
-    }
-}
-// Sort videos in input vector by published date
-std::vector<std::string> sort_videos ( std::vector<std::string> unsorted ) {
-    
-    std::vector<std::string> sorted;
-
-    int sort_count = unsorted.size();
-
-    int largest = 0;
-    int winner;
-    int epoch_release;
-    int id;
-    bool skip;
-
-    for ( int sort_i = 0; sort_i < sort_count; ++sort_i ) {
-        // Add largest epoch found to first available element in vec_browse_popular_sorted, and remove it from temp vector.
-        largest = 0;
-        winner = 0;
-
-        for ( int current_i = 0; current_i < unsorted.size(); ++current_i ) {
-            skip = false;
-            for ( int used_i = 0; used_i < sorted.size(); ++used_i ) { // check if current has been used.
-                if ( sorted[used_i] == unsorted[current_i] ) {
-                    skip = true;
-                }
+            inv_videos_vector[videonum].title = data["title"].get<std::string>();
+            inv_videos_vector[videonum].description = data["description"].get<std::string>();
+            inv_videos_vector[videonum].published = data["published"].get<int>();
+            inv_videos_vector[videonum].viewcount = data["viewCount"].get<int>();
+            inv_videos_vector[videonum].author = data["author"].get<std::string>();
+            set_video_author(videonum, data["authorId"].get<std::string>());
+            inv_videos_vector[videonum].lengthseconds = data["lengthSeconds"].get<int>();
+            record_response_health(url, true);
+            inv_videos_vector[videonum].last_updated = epoch();
+            inv_videos_vector[videonum].manual_update = true;
+            inv_videos_vector[videonum].priority_update = false;
+            log_format(1, "Video details updated for: {} With Instance: {}", videoid, inv_instances_vector[instance].name);
+            if ( popup_box ) { if ( current_selected_video == videonum ) { request_ui_update(); }}
+            return true;
+        }
+    } catch (const std::exception& e) {
+        std::stringstream parse_result;
+        parse_result << e.what();
+        log_format(2, "Error parsing JSON: {}", parse_result.str());
+        record_response_health(url, false);
+        inv_instances_vector[instance].last_get = epoch();
+        log_debug("Disabling instance for 10 minutes: {}", inv_instances_vector[instance].name);
+        return false;
+    }
+}
+// Update video Information, retrying with other instances a few times. Video is left for a later update if all attempts fail. Returns true when done.
+bool update_video_info ( const int videonum ) {
+    std::unique_lock<std::shared_mutex> lock(cache_mutex);
+    std::string videoid = inv_videos_vector[videonum].URL;
+    log_debug("Running update for video: {}", videoid);
+    for ( int attempt = 0; attempt < fetch_max_attempts; ++attempt ) {
+        auto random_instance = get_random_instance();
+        if ( ! random_instance.first ) {
+            log("Unable to retrieve instance!", 4);
+            return false;
+        }
+        std::string url = video_info_url(random_instance.second, videoid);
+        std::string hedge_url;
+        int hedge_instance = -1;
+        auto choose_hedge = [&]() { // Picked only when hedge is sent, so a half-open instance is not claimed for nothing
+            std::unique_lock<std::shared_mutex> hedge_lock(cache_mutex);
+            auto second_instance = get_random_instance();
+            if ( second_instance.first && ( second_instance.second != random_instance.second )) {
+                hedge_instance = second_instance.second;
+                hedge_url = video_info_url(hedge_instance, videoid);
             }
-            if ( skip ) {
-                continue;
+            return hedge_url;
+        };
+        lock.unlock();
+        int winner;
+        auto result = fetch_hedged(url, choose_hedge, winner);
+        parsed_video_info parsed;
+        if ( result.first ) {
+            parsed = parse_video_info_body(result.second);
+        }
+        lock.lock();
+        int instance = ( winner == 0 ) ? random_instance.second : hedge_instance;
+        const std::string& used_url = ( winner == 0 ) ? url : hedge_url;
+        api_record_response(api_video_info, used_url, result.first, result.second.size());
+        if ( ! hedge_url.empty() ) {
+            api_record_response(api_video_info, ( winner == 0 ) ? hedge_url : url, false, 0); // Cancelled or lost request
+        }
+        if ( ! result.first ) {
+            log_format(2, "Curl is unable to contact instance's API: {}", url);
+            continue;
+        }
+        if ( parse_video_info(videonum, instance, used_url, parsed) ) {
+            return true;
+        }
+    }
+    return false;
+}
+// Update video information for several videos concurrently. Failed videos are left for a later update. Returns amount of videos done.
+int update_video_info_batch ( const std::vector<int>& videos ) {
+    std::vector<fetch_request> requests;
+    int updated = 0;
+    std::deque<parsed_video_info> parsed; // deque, so entries referenced by requests stay in place
+    std::unique_lock<std::shared_mutex> lock(cache_mutex);
+    for ( int videonum : videos ) {
+        auto random_instance = get_random_instance();
+        if ( ! random_instance.first ) {
+            log("Unable to retrieve instance!", 4);
+            break;
+        }
+        int instance = random_instance.second;
+        std::string url = video_info_url(instance, inv_videos_vector[videonum].URL);
+        log_debug("Running update for video: {}", inv_videos_vector[videonum].URL);
+        parsed.emplace_back();
+        parsed_video_info& info = parsed.back();
+        requests.push_back({ url, [videonum, instance, url, &info, &updated](bool success, const std::string& body) {
+            api_record_response(api_video_info, url, success, body.size());
+            if ( ! success ) {
+                log_format(2, "Curl is unable to contact instance's API: {}", url);
+                return;
+            }
+            std::unique_lock<std::shared_mutex> lock(cache_mutex);
+            if ( parse_video_info(videonum, instance, url, info) ) {
+                ++updated;
+            }
+        }, [&info](bool success, const std::string& body) {
+            if ( success ) {
+                info = parse_video_info_body(body);
+            }
+        }});
+    }
+    lock.unlock();
+    fetch_many(requests);
+    return updated;
+}
+// Newest first by handle, used as comparator for instance popular lists.
+bool handle_newer ( const int a, const int b ) {
+    return inv_videos_vector[a].published > inv_videos_vector[b].published;
+}
+// Replace popular list of instance, keeping per video instance counts. Expects cache_mutex held.
+void set_instance_popular ( const std::string& instance_name, std::vector<int> handles ) {
+    std::vector<int>& current = popular_lists[instance_name];
+    for ( int handle : current ) {
+        --inv_videos_vector[handle].popular_instances;
+    }
+    std::stable_sort(handles.begin(), handles.end(), handle_newer);
+    for ( int handle : handles ) {
+        ++inv_videos_vector[handle].popular_instances;
+    }
+    current.swap(handles);
+}
+// Drop all instance popular lists and popular list. Expects cache_mutex held.
+void clear_browse_popular () {
+    for ( const auto& entry : popular_lists ) {
+        for ( int handle : entry.second ) {
+            --inv_videos_vector[handle].popular_instances;
+        }
+    }
+    popular_lists.clear();
+    vec_browse_popular.clear();
+}
+// Rebuild popular list with a k-way merge of instance lists, newest first. Skips duplicates and blacklisted videos. Expects cache_mutex held.
+void rebuild_browse_popular () {
+    struct cursor {
+        int published;
+        int list;
+        int position;
+    };
+    // Heap top is newest, on equal release date lower list number, so merge is stable.
+    auto later = []( const cursor& a, const cursor& b ) {
+        if ( a.published != b.published ) {
+            return a.published < b.published;
+        }
+        return a.list > b.list;
+    };
+    std::vector<std::vector<int>*> lists;
+    size_t total = 0;
+    for ( auto& entry : popular_lists ) {
+        if ( ! std::is_sorted(entry.second.begin(), entry.second.end(), handle_newer) ) { // Release dates changed since last sort.
+            std::stable_sort(entry.second.begin(), entry.second.end(), handle_newer);
+        }
+        lists.push_back(&entry.second);
+        total += entry.second.size();
+    }
+    std::priority_queue<cursor, std::vector<cursor>, decltype(later)> heap(later);
+    for ( int list = 0; list < lists.size(); ++list ) {
+        if ( lists[list]->size() != 0 ) {
+            heap.push({ inv_videos_vector[lists[list]->front()].published, list, 0 });
+        }
+    }
+
+    std::unordered_set<int> seen;
+    std::vector<std::string> merged;
+    merged.reserve(total);
+    while ( heap.size() != 0 ) {
+        cursor top = heap.top();
+        heap.pop();
+        int handle = (*lists[top.list])[top.position];
+        if ( inv_videos_vector[handle].normal_video && seen.insert(handle).second ) { // Skip blacklisted videos and duplicates
+            merged.push_back(inv_videos_vector[handle].URL);
+        }
+        if ( ++top.position < lists[top.list]->size() ) {
+            top.published = inv_videos_vector[(*lists[top.list])[top.position]].published;
+            heap.push(top);
+        }
+    }
+    vec_browse_popular.swap(merged);
+
+    // Instance lists are replaced on refresh, so list may have shrunk below cursor.
+    if (( current_menu == 1 ) && ( current_browse_type == 0 )) {
+        current_list_item = std::max(0, std::min(current_list_item, (int)vec_browse_popular.size() - 1));
+        list_shift = std::min(list_shift, current_list_item);
+    }
+}
+// Popular list URL for instance
+std::string popular_url ( const int instance ) { // https://instance.name/api/v1/popular?fields=...
+    return api_url(instance, api_popular, "popular");
+}
+// Store parsed popular list from instance, merged into popular list by rebuild_browse_popular
+bool merge_browse_popular ( const int instance, const parsed_video_list& list ) {
+    const video_list_sax& handler = list.handler;
+    if ( ! list.parsed ) {
+        log_format(3, "Error parsing JSON: {}", handler.error);
+        return false;
+    }
+    if ( ! handler.found_list ) {
+        log_debug("Instance does not support popular? {}", inv_instances_vector[instance].name);
+        return false;
+    }
+    std::vector<int> handles;
+    std::unordered_set<int> seen;
+    for ( const video_list_item& item : handler.items ) { // for each video in popular list
+        if ( item.videoid.empty() ) {
+            continue;
+        }
+        int video = store_video_list_item(item);
+        if ( ! seen.insert(video).second ) {
+            continue; // Listed twice by instance
+        }
+        if ( inv_videos_vector[video].from_popular_instance.empty() ) {
+            inv_videos_vector[video].from_popular_instance = inv_instances_vector[instance].name;
+        }
+        log_debug("Received video: {} From instance: {}", item.videoid, inv_instances_vector[instance].name);
+        handles.push_back(video);
+    }
+    set_instance_popular(inv_instances_vector[instance].name, std::move(handles));
+    return true;
+}
+// Update popular lists from all instances due for a refresh concurrently. Returns amount of lists updated.
+int update_browse_popular () {
+    std::vector<fetch_request> requests;
+    std::deque<parsed_video_list> parsed; // deque, so entries referenced by requests stay in place
+    int updated = 0;
+    std::unique_lock<std::shared_mutex> lock(cache_mutex);
+    for ( int i_instance = 0; i_instance < inv_instances_vector.size(); ++i_instance ) {
+        if ( ! (( inv_instances_vector[i_instance].enabled && inv_instances_vector[i_instance].api_enabled ) && ( inv_instances_vector[i_instance].banned == false ))) {
+            continue;
+        }
+        if ( epoch() < inv_instances_vector[i_instance].last_update_popular + 300 ) { // If last update time is less than 5 minutes.
+            continue;
+        }
+        if ( ! instance_breaker_available(inv_instances_vector[i_instance].name) ) {
+            continue;
+        }
+        instance_breaker_claim(inv_instances_vector[i_instance].name);
+        std::string url = popular_url(i_instance);
+        parsed.emplace_back();
+        parsed_video_list& list = parsed.back();
+        requests.push_back({ url, [i_instance, url, &list, &updated](bool success, const std::string& body) {
+            api_record_response(api_popular, url, success, body.size());
+            if ( ! success ) {
+                log_format(3, "Curl is unable to contact API: {}", url);
+            }
+            if ( success ) {
+                record_response_health(url, list.parsed);
+            }
+            std::unique_lock<std::shared_mutex> lock(cache_mutex);
+            if ( success && merge_browse_popular(i_instance, list) ) {
+                ++updated;
+                log_debug("Popular updated from instance: {} refreshing this instance in 5-10 minutes", inv_instances_vector[i_instance].name);
+                inv_instances_vector[i_instance].last_update_popular = epoch() + random_number(0, 300); // Add random delay to update cycle
+            } else {
+                log_debug("Popular update failed for instance, waiting 10-20 minutes: {}", inv_instances_vector[i_instance].name);
+                inv_instances_vector[i_instance].last_update_popular = epoch() + random_number(600, 1200); // Add 10-20 minutes until next check.
+            }
+        }, [&list](bool success, const std::string& body) {
+            list.parse(success, body);
+        }});
+    }
+    lock.unlock();
+    fetch_many(requests);
+    lock.lock();
+
+    if ( updated != 0 ) {
+        rebuild_browse_popular(); // Merge once for whole batch
+    }
+    return updated;
+}
+// Get channels due for a refresh, at most max channels.
+std::vector<int> get_stale_channels ( int max ) {
+    std::vector<int> channels;
+    int update_timeout = 600;
+    for ( int channel_i = 0; channel_i < inv_channels_vector.size(); ++channel_i ) {
+        if ( channels.size() >= max ) {
+            break;
+        }
+        if ( inv_channels_vector[channel_i].banned ) {
+            continue;
+        }
+        if (( inv_channels_vector[channel_i].last_updated == 0 ) || ( epoch() > inv_channels_vector[channel_i].last_updated + update_timeout )) {
+            channels.push_back(channel_i);
+        }
+    }
+    return channels;
+}
+// Channel videos URL for instance
+std::string channel_videos_url ( const int instance, const std::string& channel_id ) { // https://instancename/api/v1/channels/channelid/videos?fields=...
+    return api_url(instance, api_channel_videos, "channels/" + channel_id + "/videos");
+}
+// Merge parsed channel videos, update or add them to main video cache
+bool merge_browse_subscriptions ( const int channel_num, const int instance, const parsed_video_list& list ) {
+    const video_list_sax& handler = list.handler;
+    if ( ! list.parsed ) {
+        log_format(3, "Error parsing JSON: {}", handler.error);
+        return false;
+    }
+    // update or add videos to main video cache
+    for ( const video_list_item& item : handler.items ) {
+        if ( item.unsupported ) {
+            log("Skipping unsupported video. Live, premium or upcoming.");
+            break;
+        }
+        if ( item.videoid.empty() ) {
+            continue;
+        }
+        store_video_list_item(item);
+        log_debug("Received video: {} From instance: {}", item.videoid, inv_instances_vector[instance].name);
+    }
+    inv_channels_vector[channel_num].last_updated = epoch(); // Add timeout or update last updated field for channel.
+    log_debug("Channel: {} timeout: {}", inv_channels_vector[channel_num].id, inv_channels_vector[channel_num].last_updated); // log channel and timeout / epoch
+    return true;
+}
+// Rebuild subscriptions list from channel index, only visiting videos of subscribed channels
+void rebuild_browse_subscriptions () {
+    if ( subscribed_channels.items.size() == 0 ) {
+        log("No subscriptions...");
+        return;
+    }
+    std::vector<int> handles;
+    for ( const std::string& channel_id : subscribed_channels.items ) {
+        auto channel_videos = inv_videos_by_author.find(channel_id);
+        if ( channel_videos == inv_videos_by_author.end() ) {
+            continue;
+        }
+        handles.insert(handles.end(), channel_videos->second.begin(), channel_videos->second.end());
+    }
+    std::stable_sort(handles.begin(), handles.end(), handle_newer);
+    std::vector<std::string> vec_browse_subscriptions_temp;
+    vec_browse_subscriptions_temp.reserve(handles.size());
+    for ( int handle : handles ) {
+        vec_browse_subscriptions_temp.push_back(inv_videos_vector[handle].URL);
+    }
+    vec_browse_subscriptions.swap(vec_browse_subscriptions_temp);
+}
+// Update subscriptions list, refreshing all stale channels concurrently and rebuilding list once
+bool update_browse_subscriptions () {
+    std::unique_lock<std::shared_mutex> lock(cache_mutex);
+    std::vector<int> channels = get_stale_channels(inv_channels_vector.size());
+
+    if ( channels.size() == 0 ) {
+        log("All channel subscriptions updated!");
+        return true;
+    }
+    log_debug("Updating subscriptions from {} channels.", channels.size());
+
+    std::vector<fetch_request> requests;
+    std::deque<parsed_video_list> parsed; // deque, so entries referenced by requests stay in place
+    int channels_updated = 0;
+    for ( int channel_num : channels ) {
+        auto instance = get_random_instance();
+        if ( ! instance.first ) {
+            log("Unable to retrieve random instance", 3);
+            break;
+        }
+        int instance_num = instance.second;
+        log_debug("Updating subscriptions from channel: {}", inv_channels_vector[channel_num].id);
+        std::string url = channel_videos_url(instance_num, inv_channels_vector[channel_num].id);
+        parsed.emplace_back("videos");
+        parsed_video_list& list = parsed.back();
+        requests.push_back({ url, [channel_num, instance_num, url, &list, &channels_updated](bool success, const std::string& body) {
+            api_record_response(api_channel_videos, url, success, body.size());
+            if ( ! success ) {
+                log_format(3, "Curl is unable to contact API: {}", url);
+                return;
+            }
+            record_response_health(url, list.parsed);
+            std::unique_lock<std::shared_mutex> lock(cache_mutex);
+            if ( merge_browse_subscriptions(channel_num, instance_num, list) ) {
+                ++channels_updated;
+            }
+        }, [&list](bool success, const std::string& body) {
+            list.parse(success, body);
+        }});
+    }
+    lock.unlock();
+    fetch_many(requests);
+    lock.lock();
+
+    if ( channels_updated != 0 ) { // Rebuild and sort once for whole batch
+        rebuild_browse_subscriptions();
+        request_ui_update();
+    }
+    log_debug("Updated {} of {} stale channels.", channels_updated, channels.size());
+    return channels_updated == channels.size(); // False also when no instance was available
+}
+// Wake scheduler to plan jobs now instead of at next tick
+void wake_scheduler () {
+    {
+        std::lock_guard<std::mutex> lock(scheduler_mutex);
+        scheduler_wake = true;
+    }
+    scheduler_cv.notify_one();
+}
+// Queue job, returns false if job with same key is allready queued, running or backing off after failure.
+bool submit_job ( job_priority priority, const std::string& key, std::function<bool()> work ) {
+    {
+        std::lock_guard<std::mutex> lock(job_mutex);
+        auto backoff = job_backoffs.find(key);
+        if (( backoff != job_backoffs.end() ) && ( std::chrono::steady_clock::now() < backoff->second.next_eligible )) {
+            return false;
+        }
+        if ( ! job_keys.insert(key).second ) {
+            return false;
+        }
+        job_queues[priority].push_back({ key, std::move(work) });
+    }
+    job_cv.notify_all(); // All, as first thread does not take every class
+    return true;
+}
+// Check if job is queued or running
+bool job_pending ( const std::string& key ) {
+    std::lock_guard<std::mutex> lock(job_mutex);
+    return job_keys.count(key) != 0;
+}
+// Highest priority class with waiting jobs, up to lowest. -1 if none. Expects job_mutex held.
+int next_job_priority ( int lowest ) {
+    for ( int priority = 0; priority <= lowest; ++priority ) {
+        if ( job_queues[priority].size() != 0 ) {
+            return priority;
+        }
+    }
+    return -1;
+}
+// Job thread. Lane 0 only runs interactive and search jobs, so they never wait behind slow refreshes. A single thread runs every class.
+void THREAD_job_worker ( int lane ) {
+    int lowest = (( lane == 0 ) && ( job_threads > 1 )) ? job_search : job_speculative;
+    while ( ! collapse_threads ) {
+        job current;
+        {
+            std::unique_lock<std::mutex> lock(job_mutex);
+            int priority = -1;
+            job_cv.wait(lock, [&]{ priority = next_job_priority(lowest); return priority != -1; });
+            current = std::move(job_queues[priority].front());
+            job_queues[priority].pop_front();
+        }
+        bool success = current.work();
+        {
+            std::lock_guard<std::mutex> lock(job_mutex);
+            job_keys.erase(current.key);
+            if ( success ) {
+                job_backoffs.erase(current.key);
+            } else {
+                job_backoff& backoff = job_backoffs[current.key];
+                int delay_ms = std::min(job_backoff_base_ms << std::min(backoff.failures, 5), job_backoff_max_ms);
+                backoff.next_eligible = std::chrono::steady_clock::now() + std::chrono::milliseconds(delay_ms);
+                ++backoff.failures;
+                log_debug("Job failed: {} backing off {} ms", current.key, delay_ms);
+            }
+        }
+        ++jobs_completed;
+        if ( success ) {
+            wake_scheduler(); // Plan follow up work, ex. next speculative batch. Failed jobs wait for next tick.
+        }
+    }
+}
+// Ask for video information now, from UI. Runs before all other background work.
+void request_video_info ( const int video_num ) {
+    submit_job(job_interactive, "video:" + std::to_string(video_num), [video_num]{ return update_video_info(video_num); });
+}
+// End search job with status shown under search box, unless a newer search has taken over. Expects cache_mutex held.
+void finish_search ( int generation, const std::string& status ) {
+    if ( search_generation != generation ) {
+        return;
+    }
+    search_status = status;
+    search_running = false;
+    request_ui_update();
+}
+// Search job, tries a few instances until deadline. Stops early if a newer search is submitted.
+void update_search ( const std::string pattern, int type, int generation ) {
+    fetch_cancel cancel = { &search_generation, generation, std::chrono::steady_clock::now() + std::chrono::seconds(search_deadline_seconds) };
+    std::unique_lock<std::shared_mutex> lock(cache_mutex);
+
+    for ( int attempt = 0; attempt < fetch_max_attempts; ++attempt ) {
+        if ( fetch_cancelled(cancel) ) {
+            break;
+        }
+        search_status = "Searching... attempt " + to_string_int(attempt + 1) + "/" + to_string_int(fetch_max_attempts);
+        request_ui_update();
+
+        auto instance = get_random_instance();
+        if ( ! instance.first ) {
+            log("Unable to retrieve random instance", 3);
+            lock.unlock();
+            { // Back off while instances recover, waking early for newer search
+                std::unique_lock<std::mutex> search_lock(search_mutex);
+                search_cv.wait_for(search_lock, std::chrono::milliseconds(( 500 << attempt ) + random_number(0, 250)), [&]{ return search_generation != generation; });
             }
-            auto id_result = get_videoid_from_vector(unsorted[current_i]);
-            if ( ! id_result.first ) {
-                log("VideoID missing from main list: " + unsorted[current_i], 4);
+            lock.lock();
+            continue;
+        }
+        std::string url;
+        if ( type == 0 ) { // video
+            url = api_url(instance.second, api_search, "search", "q=" + pattern + "&type=video");
+        } else { // Channel
+            url = api_url(instance.second, api_search, "search", "q=" + pattern + "&type=channel");
+        }
+
+        lock.unlock();
+        auto result = fetch(url, &cancel);
+        video_list_sax handler;
+        bool parsed = result.first && json::sax_parse(result.second, &handler); // Parse before taking lock
+        if ( result.first ) {
+            record_response_health(url, parsed && handler.found_list);
+        }
+        lock.lock();
+        if ( fetch_cancelled(cancel) ) {
+            break;
+        }
+        api_record_response(api_search, url, result.first, result.second.size());
+
+        if ( result.first ) {
+            if ( ! parsed ) {
+                log_format(3, "Error parsing JSON: {}", handler.error);
                 continue;
             }
-            epoch_release = inv_videos_vector[id_result.second].published;
-            if ( epoch_release > largest ) {
-                largest = epoch_release;
-                winner = current_i;
+        } else {
+            log_format(3, "Curl is unable to contact API: {}", url);
+            continue;
+        }
+        if ( ! handler.found_list ) {
+            log_debug("Instance does not support search? {}", inv_instances_vector[instance.second].name);
+            continue;
+        }
+        if ( type == 0 ) {
+            vec_search_results_videos.clear();
+            for ( const video_list_item& item : handler.items ) { // for each video in search list
+                if ( item.videoid.empty() ) {
+                    continue;
+                }
+                store_video_list_item(item);
+                vec_search_results_videos.push_back(item.videoid);
+                log_debug("Received video from search: {}", item.videoid);
             }
+        } else if ( type == 1 ) {
+            // WIP
+            vec_search_results_channel.clear();
+        }
+        input_list_type.clear();
+        finish_search(generation, handler.items.size() == 0 ? "No results." : "");
+        return;
+    }
+    if ( search_generation != generation ) {
+        log_debug("Search superseded: {}", pattern);
+    } else if ( std::chrono::steady_clock::now() >= cancel.deadline ) {
+        log_format(3, "Search timed out: {}", pattern);
+        finish_search(generation, "Search timed out, press enter to retry.");
+    } else {
+        log_format(3, "Search failed after {} attempts: {}", fetch_max_attempts, pattern);
+        finish_search(generation, "No instance answered, press enter to retry.");
+    }
+}
+// Submit search job, replacing any search in progress. Expects cache_mutex held.
+void submit_search ( const std::string& pattern, int type ) {
+    log_debug("Typed Input as URL: {}", pattern);
+    int generation;
+    {
+        std::lock_guard<std::mutex> lock(search_mutex);
+        generation = ++search_generation;
+    }
+    search_cv.notify_all();
+    search_running = true;
+    search_status = "Searching...";
+    submit_job(job_search, "search:" + std::to_string(generation), [pattern, type, generation]{ update_search(pattern, type, generation); return true; });
+}
+// Add key int to key ring buffer, waits for space instead of dropping keys.
+void add_key_input ( int key = 0 ) {
+    if ( ! ( key == 0 )) {
+        while ( ! input_ring.push((unsigned char)key) ) {
+            if ( collapse_threads ) { return; }
+            usleep(100);
+        }
+    }
+}
+// Feed one byte to escape sequence decoder, adding finished key presses to events.
+void decode_key_byte ( key_decoder& decoder, unsigned char byte, std::vector<key_event>& events ) {
+    if ( decoder.state == 0 ) { // Normal
+        if ( byte == 27 ) {
+            decoder.state = 1;
+            decoder.escape_time = std::chrono::steady_clock::now();
+        } else {
+            events.push_back({ byte, 0 });
+        }
+    } else if ( decoder.state == 1 ) { // Got escape
+        if ( byte == 91 ) {             // [
+            decoder.state = 2;
+        } else if ( byte == 79 ) {      // O, arrows in application cursor mode
+            decoder.state = 3;
+        } else if ( byte == 27 ) {      // Escape pressed twice
+            events.push_back({ 27, 0 });
+            decoder.escape_time = std::chrono::steady_clock::now();
+        } else {                        // Alt + key, treat as escape followed by key
+            events.push_back({ 27, 0 });
+            events.push_back({ byte, 0 });
+            decoder.state = 0;
+        }
+    } else { // Got CSI or SS3, wait for final byte
+        if (( decoder.state == 2 ) && ( byte >= 0x20 ) && ( byte <= 0x3F )) { // Parameter byte, ex. modifiers
+            return;
+        }
+        if ( byte == 65 ) {
+            events.push_back({ 0, 1 });
+        } else if ( byte == 66 ) {
+            events.push_back({ 0, 2 });
+        } else if ( byte == 67 ) {
+            events.push_back({ 0, 3 });
+        } else if ( byte == 68 ) {
+            events.push_back({ 0, 4 });
+        } else {
+            log("Unknown combination key!", 3);
         }
-        // Add largest to sorted list
-        sorted.push_back(unsorted[winner]);
+        decoder.state = 0;
     }
-    return sorted;
 }
-// Update popular list
-bool update_browse_popular ( int instance ) { // https://instance.name/api/v1/popular
-    json data;
-    std::stringstream url;
-    url << "https://" << inv_instances_vector[instance].name << "/api/v1/popular";
-    std::string url_string = url.str();
-    auto result = fetch(url_string);
-    if ( result.first ) {
-        try {
-            data = json::parse(result.second);
-        } catch (const std::exception& e) {
-            std::stringstream parse_result;
-            parse_result << e.what();
-            log("Error parsing JSON: " + parse_result.str(), 3);
-            return false;
-        }
-    } else {
-        log("Curl is unable to contact API: " + url_string, 3);
-        return false;
+// Milliseconds until pending escape times out, -1 if no escape is pending.
+int decode_key_wait_ms ( const key_decoder& decoder ) {
+    if ( decoder.state != 1 ) {
+        return -1;
     }
-    if ( ! data.is_array() ) {
-        log("Instance does not support popular? " + inv_instances_vector[instance].name);
-        return false;
+    auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - decoder.escape_time).count();
+    return waited >= escape_timeout_ms ? 0 : escape_timeout_ms - waited;
+}
+// Turn pending escape into escape key press once no sequence followed within timeout.
+void decode_key_timeout ( key_decoder& decoder, std::vector<key_event>& events ) {
+    if ( decoder.state != 1 ) {
+        return;
     }
-
-    std::vector<std::string> vec_browse_popular_temp; // init temporary video vector
-
-    for (const auto& item : data) { // for each video in popular list
-
-        std::string videoid =   item["videoId"];
-        std::string title =     item["title"];
-        int length =            item["lengthSeconds"];
-        int published =         item["published"];
-        int viewcount =         item["viewCount"];
-        std::string author =    item["author"];
-        std::string author_id = item["authorId"];
-
-        auto video_in_list = get_videoid_from_vector(videoid);
-        int end_of_list = inv_videos_vector.size();
-
-        if ( video_in_list.first ) {
-            int video = video_in_list.second;
-            inv_videos_vector[video].title = title;
-            inv_videos_vector[video].author = author;
-            inv_videos_vector[video].author_id = author_id;
-            inv_videos_vector[video].lengthseconds = length;
-            inv_videos_vector[video].published = published;
-            inv_videos_vector[video].viewcount = viewcount;
-            if ( ! inv_videos_vector[video].from_multiple_instances ) {
-                if ( inv_instances_vector[instance].name != inv_videos_vector[video].from_popular_instance ) {
-                    inv_videos_vector[video].from_multiple_instances = true;
-                }
-            }
-        } else {
-            inv_videos_vector.push_back(inv_videos());
-            inv_videos_vector[end_of_list].URL = videoid;
-            inv_videos_vector[end_of_list].title = title;
-            inv_videos_vector[end_of_list].author = author;
-            inv_videos_vector[end_of_list].author_id = author_id;
-            inv_videos_vector[end_of_list].lengthseconds = length;
-            inv_videos_vector[end_of_list].published = published;
-            inv_videos_vector[end_of_list].viewcount = viewcount;
-            inv_videos_vector[end_of_list].from_popular_instance = inv_instances_vector[instance].name;
+    if ( std::chrono::steady_clock::now() - decoder.escape_time >= std::chrono::milliseconds(escape_timeout_ms) ) {
+        events.push_back({ 27, 0 });
+        decoder.state = 0;
+    }
+}
+// Cache serialization, little endian 32 bit integers and length prefixed strings.
+void cache_put_int ( std::string& buffer, int value ) {
+    uint32_t v = value;
+    for ( int byte = 0; byte < 4; ++byte ) {
+        buffer += (char)(( v >> ( byte * 8 )) & 0xFF );
+    }
+}
+void cache_put_string ( std::string& buffer, const std::string& value ) {
+    cache_put_int(buffer, value.size());
+    buffer += value;
+}
+void cache_put_list ( std::string& buffer, const std::vector<std::string>& list ) {
+    cache_put_int(buffer, list.size());
+    for ( const std::string& item : list ) {
+        cache_put_string(buffer, item);
+    }
+}
+// Reads cache buffer, failed is set on truncated or corrupt data.
+struct cache_reader {
+    const std::string& data;
+    size_t position = 0;
+    bool failed = false;
+
+    int get_int () {
+        if ( failed || position + 4 > data.size() ) {
+            failed = true;
+            return 0;
+        }
+        uint32_t v = 0;
+        for ( int byte = 0; byte < 4; ++byte ) {
+            v |= (uint32_t)(unsigned char)data[position + byte] << ( byte * 8 );
         }
-        log("Received video: " + videoid + " From instance: " + inv_instances_vector[instance].name);
-        // Add to temporary vector
-        vec_browse_popular_temp.push_back(videoid);
+        position += 4;
+        return (int)v;
     }
-
-    // merge to temp
-    bool merge_skip;
-    int popular_iterator_count = vec_browse_popular.size();
-    for ( int i = 0; i < popular_iterator_count; ++i ) {
-        merge_skip = false;
-        for ( int used_in_pop_i = 0; used_in_pop_i < vec_browse_popular_temp.size(); ++used_in_pop_i ) {
-            if ( vec_browse_popular_temp[used_in_pop_i] == vec_browse_popular[i] ) {
-                merge_skip = true;
-                break; // Video allready in temp, duplicate
-            }
+    std::string get_string () {
+        int length = get_int();
+        if ( failed || length < 0 || position + length > data.size() ) {
+            failed = true;
+            return "";
         }
-        if ( ! merge_skip ) {
-            vec_browse_popular_temp.push_back(vec_browse_popular[i]);
+        std::string value = data.substr(position, length);
+        position += length;
+        return value;
+    }
+    std::vector<std::string> get_list () {
+        int count = get_int();
+        std::vector<std::string> list;
+        for ( int i = 0; i < count && ! failed; ++i ) {
+            list.push_back(get_string());
         }
+        return list;
+    }
+};
+// Serialize video cache, channel state, instances and browse lists. Expects cache_mutex held.
+std::string serialize_cache () {
+    std::string buffer;
+    buffer += "VCC";
+    cache_put_int(buffer, cache_version);
+    cache_put_int(buffer, epoch());
+
+    cache_put_int(buffer, inv_videos_vector.size());
+    for ( const inv_videos& video : inv_videos_vector ) {
+        cache_put_string(buffer, video.URL);
+        cache_put_int(buffer, video.published);
+        cache_put_int(buffer, video.lengthseconds);
+        cache_put_int(buffer, video.viewcount);
+        cache_put_int(buffer, video.retry);
+        cache_put_int(buffer, video.last_updated);
+        cache_put_string(buffer, video.title);
+        cache_put_string(buffer, video.author);
+        cache_put_string(buffer, video.author_id);
+        cache_put_string(buffer, video.description);
+        cache_put_string(buffer, video.from_popular_instance);
+        cache_put_int(buffer, ( video.manual_update ? 1 : 0 ) | ( video.normal_video ? 2 : 0 ));
+    }
+
+    cache_put_int(buffer, inv_channels_vector.size());
+    for ( const inv_channels& channel : inv_channels_vector ) {
+        cache_put_string(buffer, channel.id);
+        cache_put_string(buffer, channel.name);
+        cache_put_int(buffer, channel.last_updated);
+        cache_put_int(buffer, channel.banned ? 1 : 0);
     }
 
-    std::vector<std::string> vec_browse_popular_sorted; // init temporary sorted vector, sorted largest numbers first
+    cache_put_int(buffer, inv_instances_vector.size());
+    for ( const inv_instances& instance : inv_instances_vector ) {
+        cache_put_string(buffer, instance.name);
+        cache_put_string(buffer, instance.URL);
+        cache_put_string(buffer, instance.type);
+        cache_put_string(buffer, instance.region);
+        cache_put_int(buffer, instance.health);
+        cache_put_int(buffer, instance.last_get);
+        cache_put_int(buffer, instance.last_update_popular);
+        cache_put_int(buffer, ( instance.enabled ? 1 : 0 ) | ( instance.api_enabled ? 2 : 0 ));
+    }
 
-    vec_browse_popular_sorted = sort_videos(vec_browse_popular_temp); // Sort temp by released date and add to sorted
+    cache_put_list(buffer, vec_browse_popular);
+    cache_put_list(buffer, vec_browse_subscriptions);
 
-    vec_browse_popular.clear(); // clear main vector list
-    for ( int add_i = 0; add_i < vec_browse_popular_sorted.size(); ++add_i ) { // add combined and sorted vector list for popular
-        vec_browse_popular.push_back(vec_browse_popular_sorted[add_i]);
+    cache_put_int(buffer, popular_lists.size());
+    for ( const auto& entry : popular_lists ) {
+        std::vector<std::string> ids;
+        ids.reserve(entry.second.size());
+        for ( int handle : entry.second ) {
+            ids.push_back(inv_videos_vector[handle].URL);
+        }
+        cache_put_string(buffer, entry.first);
+        cache_put_list(buffer, ids);
+    }
+    return buffer;
+}
+// Save cache to disk. Serializes under shared lock, writes to temporary file and renames it over old cache.
+bool save_cache () {
+    std::lock_guard<std::mutex> save_lock(cache_save_mutex);
+    std::string buffer;
+    {
+        std::shared_lock<std::shared_mutex> lock(cache_mutex);
+        buffer = serialize_cache();
+    }
+    std::string temporary_file = cache_file + ".tmp";
+    std::ofstream file(temporary_file, std::ios::binary | std::ios::trunc);
+    if ( ! file.is_open() ) {
+        log_format(3, "Unable to write cache file: {}", temporary_file);
+        return false;
+    }
+    file.write(buffer.data(), buffer.size());
+    file.close();
+    if ( ! file || std::rename(temporary_file.c_str(), cache_file.c_str()) != 0 ) {
+        log_format(3, "Unable to save cache file: {}", cache_file);
+        return false;
     }
+    log_debug("Saved cache: {} bytes.", buffer.size());
     return true;
 }
-// Update subscriptions list for 1 channel
-bool update_browse_subscriptions () { // https://instancename/api/v1/channels/channelid/videos
-
-    int channel_num;
-    int update_timeout = 600;
-    bool got_channel = false;
+// Load cache from disk so lists can be drawn before anything is fetched. Stale entries are revalidated in background.
+bool load_cache () {
+    std::ifstream file(cache_file, std::ios::binary);
+    if ( ! file.is_open() ) {
+        log("No cache file found, starting empty.", 1);
+        return false;
+    }
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    cache_reader reader{ data };
 
-    for ( int channel_i = 0; channel_i < inv_channels_vector.size(); ++channel_i ) {
-        if ( inv_channels_vector[channel_i].last_updated == 0 ) {
-            got_channel = true;
-        } else if ( epoch() > inv_channels_vector[channel_i].last_updated + update_timeout ) {
-            got_channel = true;
-        }
-        if ( got_channel ) {
-            if ( ! inv_channels_vector[channel_i].banned ) {
-                channel_num = channel_i;
-                break;
-            }
-            got_channel = false;
+    if ( data.compare(0, 3, "VCC") != 0 ) {
+        log("Cache file has unknown format, ignoring it.", 2);
+        return false;
+    }
+    reader.position = 3;
+    if ( reader.get_int() != cache_version ) {
+        log("Cache file is from another version, ignoring it.", 2);
+        return false;
+    }
+    int saved_time = reader.get_int();
+
+    std::deque<inv_videos> videos;
+    int video_count = reader.get_int();
+    for ( int i = 0; i < video_count && ! reader.failed; ++i ) {
+        inv_videos video;
+        video.URL = reader.get_string();
+        video.published = reader.get_int();
+        video.lengthseconds = reader.get_int();
+        video.viewcount = reader.get_int();
+        video.retry = reader.get_int();
+        video.last_updated = reader.get_int();
+        video.title = reader.get_string();
+        video.author = reader.get_string();
+        video.author_id = reader.get_string();
+        video.description = reader.get_string();
+        video.from_popular_instance = reader.get_string();
+        int flags = reader.get_int();
+        video.manual_update = flags & 1;
+        video.normal_video = flags & 2;
+        if ( epoch() - video.last_updated > cache_video_max_age ) {
+            video.manual_update = false; // Stale, refresh details in background
         }
+        videos.push_back(video);
     }
 
-    if ( ! got_channel ) {
-        log("All channel subscriptions updated!");
-        return true;
+    std::vector<inv_channels> channels;
+    int channel_count = reader.get_int();
+    for ( int i = 0; i < channel_count && ! reader.failed; ++i ) {
+        inv_channels channel;
+        channel.id = reader.get_string();
+        channel.name = reader.get_string();
+        channel.last_updated = reader.get_int();
+        channel.banned = reader.get_int() != 0;
+        channels.push_back(channel);
     }
-    log("Updating subscriptions from channel: " + inv_channels_vector[channel_num].id);
 
-    json data;
-    std::stringstream url;
-    auto instance = get_random_instance();
-    if ( ! instance.first ) {
-        log("Unable to retrieve random instance", 3);
-        return false;
+    std::vector<inv_instances> instances;
+    int instance_count = reader.get_int();
+    for ( int i = 0; i < instance_count && ! reader.failed; ++i ) {
+        inv_instances instance;
+        instance.name = reader.get_string();
+        instance.URL = reader.get_string();
+        instance.type = reader.get_string();
+        instance.region = reader.get_string();
+        instance.health = reader.get_int();
+        instance.last_get = reader.get_int();
+        instance.last_update_popular = reader.get_int();
+        int flags = reader.get_int();
+        instance.enabled = flags & 1;
+        instance.api_enabled = flags & 2;
+        instances.push_back(instance); // updated is false, so bans are applied again by update_instance_info.
     }
-    url << "https://" << inv_instances_vector[instance.second].name << "/api/v1/channels/" << inv_channels_vector[channel_num].id << "/videos";
-    std::string url_string = url.str();
-    auto result = fetch(url_string);
-    if ( result.first ) {
-        try {
-            data = json::parse(result.second);
-        } catch (const std::exception& e) {
-            std::stringstream parse_result;
-            parse_result << e.what();
-            log("Error parsing JSON: " + parse_result.str(), 3);
-            return false;
-        }
-    } else {
-        log("Curl is unable to contact API: " + url_string, 3);
+
+    std::vector<std::string> popular = reader.get_list();
+    std::vector<std::string> subscriptions = reader.get_list();
+
+    std::vector<std::pair<std::string, std::vector<std::string>>> instance_popular;
+    int popular_list_count = reader.get_int();
+    for ( int i = 0; i < popular_list_count && ! reader.failed; ++i ) {
+        std::string name = reader.get_string();
+        instance_popular.push_back({ name, reader.get_list() });
+    }
+
+    if ( reader.failed ) {
+        log("Cache file is corrupt, ignoring it.", 2);
         return false;
     }
-    // parse json output for videos, update or add them to main video cache
-    for (const auto& video : data["videos"]) {
-        if (( video["liveNow"] == true ) || ( video["premium"] == true ) || ( video["isUpcoming"] == true )) {
-            log("Skipping unsupported video. Live, premium or upcoming.");
-            break;
-        }
 
-        std::string videoid =   video["videoId"];
-        std::string title =     video["title"];
-        int length =            video["lengthSeconds"];
-        int published =         video["published"];
-        int viewcount =         video["viewCount"];
-        std::string author =    video["author"];
-        std::string author_id = video["authorId"];
-
-        auto video_in_list = get_videoid_from_vector(videoid);
-        int end_of_list = inv_videos_vector.size();
-
-        if ( video_in_list.first ) {
-            int video = video_in_list.second;
-            inv_videos_vector[video].title = title;
-            inv_videos_vector[video].author = author;
-            inv_videos_vector[video].author_id = author_id;
-            inv_videos_vector[video].lengthseconds = length;
-            inv_videos_vector[video].published = published;
-            inv_videos_vector[video].viewcount = viewcount;
-        } else {
-            inv_videos_vector.push_back(inv_videos());
-            inv_videos_vector[end_of_list].URL = videoid;
-            inv_videos_vector[end_of_list].title = title;
-            inv_videos_vector[end_of_list].author = author;
-            inv_videos_vector[end_of_list].author_id = author_id;
-            inv_videos_vector[end_of_list].lengthseconds = length;
-            inv_videos_vector[end_of_list].published = published;
-            inv_videos_vector[end_of_list].viewcount = viewcount;
+    std::unique_lock<std::shared_mutex> lock(cache_mutex);
+    inv_videos_vector.swap(videos);
+    inv_videos_index.clear();
+    inv_videos_by_author.clear();
+    for ( int handle = 0; handle < inv_videos_vector.size(); ++handle ) {
+        inv_videos_index[inv_videos_vector[handle].URL] = handle;
+        if ( ! inv_videos_vector[handle].author_id.empty() ) {
+            inv_videos_by_author[inv_videos_vector[handle].author_id].push_back(handle);
         }
-        log("Received video: " + videoid + " From instance: " + inv_instances_vector[instance.second].name);
-    }
-    inv_channels_vector[channel_num].last_updated = epoch(); // Add timeout or update last updated field for channel.
-    log("Channel: " + inv_channels_vector[channel_num].id + " timeout: " + to_string_int(inv_channels_vector[channel_num].last_updated)); // log channel and timeout / epoch
-    if ( vec_subscribed_channels.size() == 0 ) {
-        log("No subscriptions...");
-        return true;
     }
-    std::vector<std::string> vec_browse_subscriptions_temp;
-    for ( int video_i = 0; video_i < inv_videos_vector.size(); ++video_i ) {
-        for ( int sub_i = 0; sub_i < vec_subscribed_channels.size(); ++sub_i ) {
-            if ( inv_videos_vector[video_i].author_id == vec_subscribed_channels[sub_i] ) {
-                vec_browse_subscriptions_temp.push_back(inv_videos_vector[video_i].URL);
+    inv_channels_vector.swap(channels);
+    inv_instances_vector.swap(instances);
+    vec_browse_popular = popular;
+    vec_browse_subscriptions = subscriptions;
+    popular_lists.clear();
+    for ( const auto& entry : instance_popular ) {
+        std::vector<int> handles;
+        for ( const std::string& id : entry.second ) {
+            auto video = get_videoid_from_vector(id);
+            if ( video.first ) {
+                handles.push_back(video.second);
             }
         }
+        set_instance_popular(entry.first, std::move(handles));
     }
-    std::vector<std::string> vec_browse_subscriptions_sorted = sort_videos(vec_browse_subscriptions_temp);
-
-    vec_browse_subscriptions.clear(); // clear main vector list
-    for ( int add_i = 0; add_i < vec_browse_subscriptions_sorted.size(); ++add_i ) { // add combined and sorted vector list for popular
-        vec_browse_subscriptions.push_back(vec_browse_subscriptions_sorted[add_i]);
+    if ( inv_instances_vector.size() != 0 ) {
+        cache_instances_time = saved_time;
+        local_instances_updated = true;
     }
-
+    log_format(1, "Loaded cache: {} videos, {} channels, {} instances.", inv_videos_vector.size(), inv_channels_vector.size(), inv_instances_vector.size());
     return true;
 }
-// Search function
-void update_search ( const std::string pattern, int type ) {
-    std::stringstream url_stream;
-    json data;
-
-    if ( type == 0 ) {
-        vec_search_results_videos.clear();
-    } else {
-        vec_search_results_channel.clear();
-    }
-
-    while ( true ) {
-        auto instance = get_random_instance();
-        if ( ! instance.first ) {
-            log("Unable to retrieve random instance", 3);
+// Check if any instance popular list is due for refresh. Expects cache_mutex held.
+bool popular_refresh_due () {
+    for ( int i_instance = 0; i_instance < inv_instances_vector.size(); ++i_instance ) {
+        if ( ! (( inv_instances_vector[i_instance].enabled && inv_instances_vector[i_instance].api_enabled ) && ( inv_instances_vector[i_instance].banned == false ))) {
             continue;
         }
-        if ( type == 0 ) { // video
-            url_stream << "https://" << inv_instances_vector[instance.second].name << "/api/v1/search?q=" << pattern << "&type=video";
-        } else { // Channel
-            url_stream << "https://" << inv_instances_vector[instance.second].name << "/api/v1/search?q=" << pattern << "&type=channel";
+        if ( epoch() < inv_instances_vector[i_instance].last_update_popular + 300 ) {
+            continue;
         }
-        std::string url = url_stream.str();
-
-        auto result = fetch(url);
-
-        if ( result.first ) {
-            try {
-                data = json::parse(result.second);
-            } catch (const std::exception& e) {
-                std::stringstream parse_result;
-                parse_result << e.what();
-                log("Error parsing JSON: " + parse_result.str(), 3);
-                continue;
+        if ( instance_breaker_available(inv_instances_vector[i_instance].name) ) {
+            return true;
+        }
+    }
+    return false;
+}
+// Scheduler state kept between planning rounds
+struct scheduler_state {
+    std::chrono::steady_clock::time_point next_speculative;
+    std::chrono::steady_clock::time_point next_prefetch;
+    int prefetched_generation = 0;              // Viewport generation last queued for prefetch
+};
+// Check if video still needs details fetched. Expects cache_mutex held.
+bool video_needs_details ( const int video ) {
+    return ( video < inv_videos_vector.size() ) && ( ! inv_videos_vector[video].manual_update ) && inv_videos_vector[video].normal_video;
+}
+// Queue prefetch of visible rows, then next page in scroll direction. Returns true if any rows are waiting for details. Expects cache_mutex held.
+bool plan_prefetch ( scheduler_state& state ) {
+    std::vector<int> visible;
+    std::vector<int> upcoming;
+    int generation;
+    {
+        std::lock_guard<std::mutex> lock(viewport_mutex);
+        generation = viewport_generation;
+        for ( int video : viewport_visible ) {
+            if ( video_needs_details(video) ) { visible.push_back(video); }
+        }
+        for ( int video : viewport_upcoming ) {
+            if ( video_needs_details(video) ) { upcoming.push_back(video); }
+        }
+    }
+    if (( visible.size() == 0 ) && ( upcoming.size() == 0 )) {
+        return false;
+    }
+    if (( generation == state.prefetched_generation ) && ( std::chrono::steady_clock::now() < state.next_prefetch )) {
+        return true; // Queued allready, failed rows are retried later
+    }
+    bool queued = true;
+    if ( visible.size() != 0 ) {
+        queued = submit_job(job_visible, "visible", [visible]{ return update_video_info_batch(visible) != 0; }) && queued;
+    }
+    if ( upcoming.size() != 0 ) {
+        queued = submit_job(job_visible, "upcoming", [upcoming]{ return update_video_info_batch(upcoming) != 0; }) && queued;
+    }
+    if ( queued ) {
+        log_debug("Prefetching {} visible and {} upcoming videos.", visible.size(), upcoming.size());
+        state.prefetched_generation = generation;
+        state.next_prefetch = std::chrono::steady_clock::now() + std::chrono::seconds(viewport_retry_seconds);
+    }
+    return true;
+}
+// Queue jobs for work that is due. Expects cache_mutex held.
+void plan_jobs ( scheduler_state& state ) {
+    for ( int i_instance = 0; i_instance < inv_instances_vector.size(); ++i_instance ) {
+        if ( ! inv_instances_vector[i_instance].updated ) {
+            update_instance_info(i_instance);
+        }
+    }
+    if ( inv_channels_vector.size() < subscribed_channels.items.size() ) {
+        std::unordered_set<std::string> channels_in_list;
+        for ( const inv_channels& channel : inv_channels_vector ) {
+            channels_in_list.insert(channel.id);
+        }
+        for ( int channel_i2 = 0; channel_i2 < subscribed_channels.items.size(); ++channel_i2 ) {
+            if ( channels_in_list.count(subscribed_channels.items[channel_i2]) == 0 ) {
+                int end_of_list = inv_channels_vector.size();
+                inv_channels_vector.push_back(inv_channels());
+                inv_channels_vector[end_of_list].id = subscribed_channels.items[channel_i2];
+                inv_channels_vector[end_of_list].last_updated = 0;
+                inv_channels_vector[end_of_list].banned = false;
+                inv_channels_vector[end_of_list].name = "null";
             }
-        } else {
-            log("Curl is unable to contact API: " + url, 3);
-            continue;
         }
-        if ( ! data.is_array() ) {
-            log("Instance does not support search? " + inv_instances_vector[instance.second].name);
-            continue;
+    }
+    for ( int video_update_iteration = 0; video_update_iteration < inv_videos_vector.size(); ++video_update_iteration ) {
+        // For loop over each video in video cache, marking local list state
+        inv_videos_vector[video_update_iteration].favorite = config_list_contains(favorited_videos, inv_videos_vector[video_update_iteration].URL);
+        inv_videos_vector[video_update_iteration].downloaded = config_list_contains(downloaded_videos, inv_videos_vector[video_update_iteration].URL);
+    }
+    for ( int video_priority_update_iteration = 0; video_priority_update_iteration < inv_videos_vector.size(); ++video_priority_update_iteration ) {
+        if (( inv_videos_vector[video_priority_update_iteration].priority_update ) && ( inv_videos_vector[video_priority_update_iteration].normal_video )) {
+            request_video_info(video_priority_update_iteration); // Refresh requested by user
         }
-        if ( type == 0 ) {
-            for (const auto& item : data) { // for each video in search list
-
-                std::string videoid =   item["videoId"];
-                std::string title =     item["title"];
-                int length =            item["lengthSeconds"];
-                int published =         item["published"];
-                int viewcount =         item["viewCount"];
-                std::string author =    item["author"];
-                std::string author_id = item["authorId"];
-
-                auto video_in_list = get_videoid_from_vector(videoid);
-                int end_of_list = inv_videos_vector.size();
-
-                if ( video_in_list.first ) {
-                    int video = video_in_list.second;
-                    inv_videos_vector[video].title = title;
-                    inv_videos_vector[video].author = author;
-                    inv_videos_vector[video].author_id = author_id;
-                    inv_videos_vector[video].lengthseconds = length;
-                    inv_videos_vector[video].published = published;
-                    inv_videos_vector[video].viewcount = viewcount;
-                } else {
-                    inv_videos_vector.push_back(inv_videos());
-                    inv_videos_vector[end_of_list].URL = videoid;
-                    inv_videos_vector[end_of_list].title = title;
-                    inv_videos_vector[end_of_list].author = author;
-                    inv_videos_vector[end_of_list].author_id = author_id;
-                    inv_videos_vector[end_of_list].lengthseconds = length;
-                    inv_videos_vector[end_of_list].published = published;
-                    inv_videos_vector[end_of_list].viewcount = viewcount;
+    }
+    if ( browse_opened ) {
+        if ( popular_refresh_due() ) {
+            submit_job(job_background, "popular", []{
+                if ( update_browse_popular() != 0 ) { // Update all popular lists due for refresh
+                    request_ui_update();
+                    return true;
                 }
-                vec_search_results_videos.push_back(videoid);
-            log("Received video from search: " + videoid);
-            }
-            break;
-        } else if ( type == 1 ) {
-            // WIP
-            break;
+                return false;
+            });
+        }
+        if (( inv_channels_vector.size() != 0 ) && ( get_stale_channels(1).size() != 0 )) {
+            submit_job(job_background, "subscriptions", []{ return update_browse_subscriptions(); });
         }
     }
-}
-// Add key int to key list vector.
-void add_key_input ( int key = 0 ) {
-    if ( ! ( key == 0 )) {
-        input_list.push_back(key);
+    // Details for rows on screen first. Random videos are filled in only when nothing shown is missing details, at most one batch per second
+    if ( plan_prefetch(state) ) {
+        return;
+    }
+    if (( std::chrono::steady_clock::now() >= state.next_speculative ) && ( inv_videos_vector.size() != 0 ) && ( ! job_pending("speculative") )) {
+        int random_num = random_number(0 , inv_videos_vector.size() - 1);
+        int video_update_iteration_tmp;
+        std::vector<int> videos_to_update;
+        for ( int video_update_iteration = 0; video_update_iteration < inv_videos_vector.size(); ++video_update_iteration ) {
+            video_update_iteration_tmp = video_update_iteration + random_num;
+            if ( video_update_iteration_tmp >= inv_videos_vector.size() ) {
+                video_update_iteration_tmp = video_update_iteration_tmp - inv_videos_vector.size();
+            }
+            if (( ! inv_videos_vector[video_update_iteration_tmp].manual_update ) && ( inv_videos_vector[video_update_iteration_tmp].normal_video )) {
+                videos_to_update.push_back(video_update_iteration_tmp);
+                if ( videos_to_update.size() >= fetch_max_in_flight ) {
+                    break;
+                }
+            }
+        }
+        if ( videos_to_update.size() != 0 ) {
+            submit_job(job_speculative, "speculative", [videos_to_update]{ return update_video_info_batch(videos_to_update) != 0; }); // Update batch of videos concurrently
+            state.next_speculative = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        }
     }
 }
-// Background worker and update thread.
-void THREAD_background_worker () {
+// Scheduler thread, plans jobs each second or when woken by an event.
+void THREAD_scheduler () {
 
-    int last_update_instances;
-    int random_num;
+    int last_update_instances = 0;
+    int next_instances_attempt = 0;
     int instances_update_attempts = 0;
-    bool one_video_updated;
+    bool instances_loaded;
+    scheduler_state state;
 
-    update_instances(); // Update local instances.
-    last_update_instances = epoch();
-    log("WRK_THR: Instances updated.");
+    int last_cache_save = epoch();
 
-    while ( true ) {
-        one_video_updated = false;
-        if ( collapse_threads ) { break; }
-        if ( inv_instances_vector.size() != 0 ) {
+    if (( cache_instances_time != 0 ) && ( epoch() < cache_instances_time + 600 )) { // Cached instances still fresh
+        last_update_instances = cache_instances_time;
+        log("SCHED: Using cached instances.");
+    }
+
+    while ( ! collapse_threads ) {
+        {
+            std::shared_lock<std::shared_mutex> lock(cache_mutex);
+            instances_loaded = inv_instances_vector.size() != 0;
+        }
+        if ( instances_loaded ) {
             instances_update_attempts = 0;
-            // instances loaded
             if ( epoch() >= last_update_instances + 600 ) {
                 log("Instances not updated in 10 minutes, updating now...", 1);
-                update_instances();
+                submit_job(job_background, "instances", []{ return update_instances(); });
                 last_update_instances = epoch();
             }
-            for ( int i_instance = 0; i_instance < inv_instances_vector.size(); ++i_instance ) {
-                if ( ! inv_instances_vector[i_instance].updated ) {
-                    update_instance_info(i_instance);
-                }
-                if ( ( inv_instances_vector[i_instance].enabled && inv_instances_vector[i_instance].api_enabled ) && ( inv_instances_vector[i_instance].banned == false ) ) {
-                    // Instance loop for enabled and unbanned instances.
-
-                    if ( browse_opened ) {
-                        if ( epoch() >= inv_instances_vector[i_instance].last_update_popular + 300 ) { // If last update time is more than 5 minutes.
-                            if ( update_browse_popular(i_instance) ) {
-                                update_ui = true;
-                                log("Popular updated from instance: " + inv_instances_vector[i_instance].name + " refreshing this instance in 5-10 minutes");
-                                inv_instances_vector[i_instance].last_update_popular = epoch() + random_number(0, 300); // Add random delay to update cycle
-                                for ( int banned_video_i = 0; banned_video_i < inv_videos_vector.size(); ++banned_video_i ) {
-                                    if ( ! inv_videos_vector[banned_video_i].normal_video ) {
-                                        for ( int banned_popular_i = 0; banned_popular_i < vec_browse_popular.size(); ++banned_popular_i ) {
-                                            if ( inv_videos_vector[banned_video_i].URL == vec_browse_popular[banned_popular_i] ) {
-                                                vec_browse_popular.erase(vec_browse_popular.begin() + banned_popular_i); // Remove banned videos from popular list.
-                                            }
-                                        }
-                                    }
-                                }
-                                break; // Break loop to update 1 popular list each iteration.
-                            } else {
-                                log("Popular update failed for instance, waiting 10-20 minutes: " + inv_instances_vector[i_instance].name);
-                                inv_instances_vector[i_instance].last_update_popular = epoch() + random_number(600, 1200); // Add 10-20 minutes until next check.
-                            }
-                        }
-                    }
-                }
-            }
-            if ( inv_channels_vector.size() < vec_subscribed_channels.size() ) {
-                for ( int channel_i2 = 0; channel_i2 < vec_subscribed_channels.size(); ++channel_i2 ) {
-                    bool channel_in_list = false;
-                    for ( int channel_i = 0; channel_i < inv_channels_vector.size(); ++channel_i ) {
-                        if ( inv_channels_vector[channel_i].id == vec_subscribed_channels[channel_i2] ) {
-                            channel_in_list = true;
-                            break;
-                        }
-                    }
-                    if ( ! channel_in_list ) {
-                        int end_of_list = inv_channels_vector.size();
-                        inv_channels_vector.push_back(inv_channels());
-                        inv_channels_vector[end_of_list].id = vec_subscribed_channels[channel_i2];
-                        inv_channels_vector[end_of_list].last_updated = 0;
-                        inv_channels_vector[end_of_list].banned = false;
-                        inv_channels_vector[end_of_list].name = "null";
-                    }
-                }
-            }
-            if ( ! ( inv_channels_vector.size() == 0 )) {
-                if ( browse_opened ) {
-                    update_browse_subscriptions();
-                }
-                if ( typing_mode_result ) {
-                    if ( input_list_type.size() != 0 ) {
-                        log("Typed Input as URL: " + ascii_vector_to_string(input_list_type, true));
-                    }
-                    update_search(ascii_vector_to_string(input_list_type, true), search_type);
-
-                    input_list_type.clear();
-                    typing_mode_result = false;
-                }
-                for ( int video_update_iteration = 0; video_update_iteration < inv_videos_vector.size(); ++video_update_iteration ) {
-                    // For loop over each video in video cache
-                    for ( int video_update_iteration_favorite = 0; video_update_iteration_favorite < vec_favorited_videos.size(); ++video_update_iteration_favorite ) {
-                        if ( inv_videos_vector[video_update_iteration].URL == vec_favorited_videos[video_update_iteration_favorite] ) {
-                            if ( ! inv_videos_vector[video_update_iteration].favorite ) {
-                                inv_videos_vector[video_update_iteration].favorite = true;
-                            }
-                        }
-                    }
-                }
-                for ( int video_priority_update_iteration = 0; video_priority_update_iteration < inv_videos_vector.size(); ++video_priority_update_iteration ) {
-                    if (( inv_videos_vector[video_priority_update_iteration].priority_update ) && ( inv_videos_vector[video_priority_update_iteration].normal_video )) {
-                        update_video_info(video_priority_update_iteration);
-                        one_video_updated = true;
-                        break;
-                    }
-                }
-                if (( ! one_video_updated ) && ( inv_videos_vector.size() != 0 )) {
-                    random_num = random_number(0 , inv_videos_vector.size() - 1);
-                    int video_update_iteration_tmp;
-                    for ( int video_update_iteration = 0; video_update_iteration < inv_videos_vector.size(); ++video_update_iteration ) {
-                        video_update_iteration_tmp = video_update_iteration + random_num;
-                        if ( video_update_iteration_tmp >= inv_videos_vector.size() ) {
-                            video_update_iteration_tmp = video_update_iteration_tmp - inv_videos_vector.size();
-                        }
-                        if (( ! inv_videos_vector[video_update_iteration_tmp].manual_update ) && ( inv_videos_vector[video_update_iteration_tmp].normal_video )) {
-                            update_video_info(video_update_iteration_tmp);
-                            one_video_updated = true;
-                            break;
-                        }
-                    }
-                }
-            }
-        } else { // Attempt again after 10 seconds.
-            log("Unable to update instances. Attempt number: " + to_string_int(instances_update_attempts));
+            std::unique_lock<std::shared_mutex> lock(cache_mutex);
+            plan_jobs(state);
+        } else if (( epoch() >= next_instances_attempt ) && ( ! job_pending("instances") )) { // Attempt again after 10 seconds.
+            log_debug("Unable to update instances. Attempt number: {}", instances_update_attempts);
             if ( instances_update_attempts > 4 ) {
-                log("Instances update attempted 5 times. Sleeping for 60s...", 4);
+                log("Instances update attempted 5 times. Waiting 60s...", 4);
                 instances_update_attempts = 0;
-                usleep(60000000); // 60s
+                next_instances_attempt = epoch() + 60;
             } else {
-                log("Attempting instance refresh.", 3);
+                if ( instances_update_attempts != 0 ) {
+                    log("Attempting instance refresh.", 3);
+                }
                 ++instances_update_attempts;
+                next_instances_attempt = epoch() + 10;
+                submit_job(job_background, "instances", []{ return update_instances(); });
+                last_update_instances = epoch();
             }
-            update_instances();
         }
-        usleep(1000000); // 1s sleep
+        if ( epoch() >= last_cache_save + cache_save_interval ) {
+            submit_job(job_background, "cache", []{
+                {
+                    std::unique_lock<std::shared_mutex> lock(cache_mutex);
+                    config_list_compact(subscribed_channels);
+                    config_list_compact(downloaded_videos);
+                    config_list_compact(favorited_videos);
+                }
+                return save_cache();
+            });
+            last_cache_save = epoch();
+        }
+        std::unique_lock<std::mutex> lock(scheduler_mutex);
+        scheduler_cv.wait_for(lock, std::chrono::seconds(1), []{ return scheduler_wake; });
+        scheduler_wake = false;
     }
 }
 // Input thread keeping track of inputs, and adding to queue.
@@ -1244,83 +3436,71 @@ void THREAD_input () {
             break;
         }
 
-        char_input_character=getchar();
+        int read_character = getchar();
+        if ( read_character == EOF ) { // stdin closed, stop instead of spinning on EOF
+            log("Input closed, stopping input thread.", 2);
+            break;
+        }
+        char_input_character = read_character;
         input_character = (int)char_input_character;
 
         add_key_input(input_character);
+        wake_ui();
     }
     tcsetattr(STDIN_FILENO,TCSANOW,&old_tattr);
 }
 // input processing
 void calculate_inputs () {
 
-    if ( input_list.size() == 1 ) {
-        usleep(5000);
-        if ( input_list.size() == 1 ) {
-            if ( input_list[0] == 27 ) {
-                if ( input_character == 27 ) {
-                    log("Received escape key.", 1);
-                    if ( popup_box ) {
-                        popup_box = false;
-                    } else if ( current_menu == 0 ) {
-                        collapse_threads = true;
-                    } else if ( typing_mode ) {
-                        typing_mode = false;
-                        input_list_type.clear();
-                    } else {
-                        quit = true;
-                    }
-                    input_list.clear();
-                    return;
-                }
-            }
-        }
+    std::vector<key_event> events;
+    unsigned char byte;
+    while ( input_ring.pop(byte) ) {
+        decode_key_byte(input_decoder, byte, events);
     }
+    decode_key_timeout(input_decoder, events);
 
-    if ( ! ( input_list.size() == 0 )) {
+    if ( ! ( events.size() == 0 )) {
+
+        std::unique_lock<std::shared_mutex> lock(cache_mutex);
 
         update_ui = true;
         int list_item_limit = 0;
-        int key_arrow_type = 0; // Type of arrow key. 0-Null, 1-UP, 2-Down, 3-Left, 4-Right
-
-        for (unsigned i=0; i<input_list.size(); i++) { // Main check loop.
-            if ( input_list.size() == 3 ) { // Check if arrow keys.
-                if ( input_list[i] == 27 ){
-                    i++;
-                    if ( input_list[i] == 91 ){
-                        i++;
-                        if ( input_list[i] == 65 ) {
-                            key_arrow_type = 1;
-                        } else if ( input_list[i] == 66 ) {
-                            key_arrow_type = 2;
-                        } else if ( input_list[i] == 67 ) {
-                            key_arrow_type = 3;
-                        } else if ( input_list[i] == 68 ) {
-                            key_arrow_type = 4;
-                        } else {
-                            log("Unknown combination key!", 3);
-                        }
-                    } else {
-                        log("Unknown combination key!", 3);
-                    }
+
+        for ( const key_event& event : events ) { // Main check loop.
+            int key = event.key;
+            int key_arrow_type = event.arrow; // Type of arrow key. 0-Null, 1-UP, 2-Down, 3-Left, 4-Right
+
+            log_debug("Input key: {} Arrow: {}", key, key_arrow_type);
+
+            if ( key == 27 ) { // Escape key
+                log("Received escape key.", 1);
+                if ( popup_box ) {
+                    popup_box = false;
+                } else if ( current_menu == 0 ) {
+                    collapse_threads = true;
+                } else if ( typing_mode ) {
+                    typing_mode = false;
+                    input_list_type.clear();
+                } else {
+                    quit = true;
                 }
+                continue;
             }
-            log("Input vector iteration: " + to_string_int(i) + " Value: " + to_string_int(input_list[i]));
 
             if ( ! typing_mode ) {
-                if ( input_list[i] == 49 ) {      current_menu = 0; popup_box = false; current_list_item = 0; } // Key 1 pressed / main menu
-                else if ( input_list[i] == 50 ) { current_menu = 1; popup_box = false; current_list_item = 0; } // Key 2 pressed / browse
-                else if ( input_list[i] == 51 ) { current_menu = 2; popup_box = false; current_list_item = 0; search_field = 1; } // Key 3 pressed / search
-                else if ( input_list[i] == 52 ) { current_menu = 3; popup_box = false; current_list_item = 0; } // Key 4 pressed / Status
-                else if ( input_list[i] == 53 ) { current_menu = 4; popup_box = false; current_list_item = 0; } // key 5 pressed / Settings
-                else if ( input_list[i] == 113 ) { // Q - Quit
+                if ( key == 49 ) {      current_menu = 0; popup_box = false; current_list_item = 0; } // Key 1 pressed / main menu
+                else if ( key == 50 ) { current_menu = 1; popup_box = false; current_list_item = 0; } // Key 2 pressed / browse
+                else if ( key == 51 ) { current_menu = 2; popup_box = false; current_list_item = 0; search_field = 1; } // Key 3 pressed / search
+                else if ( key == 52 ) { current_menu = 3; popup_box = false; current_list_item = 0; } // Key 4 pressed / Status
+                else if ( key == 53 ) { current_menu = 4; popup_box = false; current_list_item = 0; } // key 5 pressed / Settings
+                else if ( key == 113 ) { // Q - Quit
                     if ( popup_box ) {
                         popup_box = false;
                     } else {
                         quit = true;
                     }
                 }
-                else if ( input_list[i] == 10 ) { // Return key
+                else if ( key == 10 ) { // Return key
                     if ((( current_menu == 1 ) || ( current_menu == 2 )) && ( ! popup_box ) && ( current_list_loaded )) {
                         popup_box = true;
                     }
@@ -1412,78 +3592,57 @@ void calculate_inputs () {
                         }
                     }
                 }
-                else if ( input_list[i] == 102 ) { // F - Favorite
+                else if ( key == 102 ) { // F - Favorite
                     if ( current_menu == 1 ) {
                         if ( current_browse_type == 0 ) { // ToDo: Combine current menu 0 and 1
                             if ( vec_browse_popular.size() != 0 ) {
                                 if ( inv_videos_vector[current_selected_video].favorite ) {
-                                    remove_matching_lines(config_file_favorites, inv_videos_vector[current_selected_video].URL);
+                                    config_list_remove(favorited_videos, inv_videos_vector[current_selected_video].URL);
                                     inv_videos_vector[current_selected_video].favorite = false;
-                                    log("Removed video from favorites: " + inv_videos_vector[current_selected_video].URL);
-                                    for ( int fav = 0; fav < vec_favorited_videos.size(); ++fav ) {
-                                        if ( vec_favorited_videos[fav] == inv_videos_vector[current_selected_video].URL ) {
-                                            vec_favorited_videos.erase(vec_favorited_videos.begin() + fav);
-                                        }
-                                    }
+                                    log_debug("Removed video from favorites: {}", inv_videos_vector[current_selected_video].URL);
                                 } else {
-                                    append_file(config_file_favorites, inv_videos_vector[current_selected_video].URL, true);
+                                    config_list_add(favorited_videos, inv_videos_vector[current_selected_video].URL);
                                     inv_videos_vector[current_selected_video].favorite = true;
-                                    log("Added video to favorites: " + inv_videos_vector[current_selected_video].URL);
-                                    vec_favorited_videos.push_back(inv_videos_vector[current_selected_video].URL);
+                                    log_debug("Added video to favorites: {}", inv_videos_vector[current_selected_video].URL);
                                 }
                             }
                         } else if ( current_browse_type == 1 ) {
                             if ( vec_browse_subscriptions.size() != 0 ) {
                                 if ( inv_videos_vector[current_selected_video].favorite ) {
-                                    remove_matching_lines(config_file_favorites, inv_videos_vector[current_selected_video].URL);
+                                    config_list_remove(favorited_videos, inv_videos_vector[current_selected_video].URL);
                                     inv_videos_vector[current_selected_video].favorite = false;
-                                    log("Removed video from favorites: " + inv_videos_vector[current_selected_video].URL);
-                                    for ( int fav = 0; fav < vec_favorited_videos.size(); ++fav ) {
-                                        if ( vec_favorited_videos[fav] == inv_videos_vector[current_selected_video].URL ) {
-                                            vec_favorited_videos.erase(vec_favorited_videos.begin() + fav);
-                                        }
-                                    }
+                                    log_debug("Removed video from favorites: {}", inv_videos_vector[current_selected_video].URL);
                                 } else {
-                                    append_file(config_file_favorites, inv_videos_vector[current_selected_video].URL, true);
+                                    config_list_add(favorited_videos, inv_videos_vector[current_selected_video].URL);
                                     inv_videos_vector[current_selected_video].favorite = true;
-                                    log("Added video to favorites: " + inv_videos_vector[current_selected_video].URL);
-                                    vec_favorited_videos.push_back(inv_videos_vector[current_selected_video].URL);
+                                    log_debug("Added video to favorites: {}", inv_videos_vector[current_selected_video].URL);
                                 }
                             }
                         }
                     }
                 }
-                else if ( input_list[i] == 115 ) { // S - Subscribe, only works within detailed popup view.
+                else if ( key == 115 ) { // S - Subscribe, only works within detailed popup view.
                     if (( current_menu == 1 ) || ( current_menu == 2 )) {
                         if ( inv_videos_vector.size() != 0 ) {
-                            bool channel_subscribed = false;
-                            int channel_subscribed_id;
-                            for ( int check_subscribe_iteration = 0; check_subscribe_iteration < vec_subscribed_channels.size(); ++check_subscribe_iteration ) {
-                                if ( vec_subscribed_channels[check_subscribe_iteration] == inv_videos_vector[current_selected_video].author_id ) {
-                                    channel_subscribed = true;
-                                    channel_subscribed_id = check_subscribe_iteration;
-                                    break;
-                                }
-                            }
-                            if ( channel_subscribed ) {
-                                remove_matching_lines(config_file_subscriptions, vec_subscribed_channels[channel_subscribed_id]);
-                                log("Unsubscribing from: " + vec_subscribed_channels[channel_subscribed_id]);
-                                vec_subscribed_channels.erase(vec_subscribed_channels.begin() + channel_subscribed_id);
+                            const std::string& channel_id = inv_videos_vector[current_selected_video].author_id;
+                            if ( config_list_contains(subscribed_channels, channel_id) ) {
+                                log_debug("Unsubscribing from: {}", channel_id);
+                                config_list_remove(subscribed_channels, channel_id);
                             } else {
-                                append_file(config_file_subscriptions, inv_videos_vector[current_selected_video].author_id, true);
-                                log("Subscribed to channel: " + inv_videos_vector[current_selected_video].author_id);
-                                vec_subscribed_channels.push_back(inv_videos_vector[current_selected_video].author_id);
+                                config_list_add(subscribed_channels, channel_id);
+                                log_debug("Subscribed to channel: {}", channel_id);
                             }
                         }
                     }
                 }
-                else if ( input_list[i] == 114 ) { // R - Reset current list / refresh
+                else if ( key == 114 ) { // R - Reset current list / refresh
                     if ( current_menu == 1 ) {
                         if ( popup_box ) {
                             inv_videos_vector[current_selected_video].priority_update = true;
+                            wake_scheduler();
                         } else if ( current_browse_type == 0 ) { // popular
                             current_list_item = 0;
-                            vec_browse_popular.clear();
+                            clear_browse_popular();
                             for ( int i = 0; i < inv_instances_vector.size(); ++i ) { // Reset popular instance refresh timeout
                                 if (( inv_instances_vector[i].enabled && inv_instances_vector[i].api_enabled ) && ( inv_instances_vector[i].banned == false )) {
                                     inv_instances_vector[i].last_update_popular = epoch() + 301;
@@ -1501,6 +3660,7 @@ void calculate_inputs () {
                     } else if ( current_menu == 2 ) {
                         if ( popup_box ) {
                             inv_videos_vector[current_selected_video].priority_update = true;
+                            wake_scheduler();
                         } else {
                             if ( vec_search_results_videos.size() != 0 ) {
                                 vec_search_results_videos.clear();
@@ -1511,9 +3671,9 @@ void calculate_inputs () {
                         }
                     }
                 }
-                else { log("Key unknown: " + to_string_int(input_list[i])); }
+                else { log_debug("Key unknown: {}", key); }
             } else { // Typing mode enabled.
-                if ( input_list[i] == 127 ) {
+                if ( key == 127 ) {
                     if ( input_list_type.size() != 0 ) {
                         input_list_type.pop_back();
                     }
@@ -1523,23 +3683,69 @@ void calculate_inputs () {
                     search_field = 1;
                     continue;
                 }
-                if ((( input_list[i] >= 65 ) && ( input_list[i] <= 90 )) || (( input_list[i] >= 97 ) && ( input_list[i] <= 122 )) || (( input_list[i] >= 48 ) && ( input_list[i] <= 57 )) || ( input_list[i] == 32 )) { // Check for alphabetical or numerical input
-                    input_list_type.push_back(input_list[i]);
-                    log("Added character: " + to_string_int(input_list[i]) + " To user type list.");
+                if ((( key >= 65 ) && ( key <= 90 )) || (( key >= 97 ) && ( key <= 122 )) || (( key >= 48 ) && ( key <= 57 )) || ( key == 32 )) { // Check for alphabetical or numerical input
+                    input_list_type.push_back(key);
+                    log_debug("Added character: {} To user type list.", key);
+                    if ( ! search_running ) {
+                        search_status.clear(); // Old result no longer matches typed text
+                    }
                 }
-                if ( input_list[i] == 10 ) { // Return key, disabled type mode, and signals that query / usage of typed content can be started.
+                if ( key == 10 ) { // Return key, disabled type mode, and signals that query / usage of typed content can be started.
                     typing_mode = false;
                     search_field = 1;
-                    typing_mode_result = true;
+                    submit_search(ascii_vector_to_string(input_list_type, true), search_type);
                     continue;
                 }
             }
         }
-        input_list.clear();
     } else {
         return;
     }
 }
+// Publish rows shown in video list for prefetch, nearest to cursor first, and next page in scroll direction. Expects cache_mutex held.
+void publish_viewport ( const std::vector<std::string>& video_vector, int list_length ) {
+    if ( current_list_item != viewport_last_item ) {
+        viewport_direction = ( current_list_item > viewport_last_item ) ? 1 : -1;
+        viewport_last_item = current_list_item;
+    }
+    int first = list_shift;
+    int last = std::min(list_shift + list_length, (int)video_vector.size()) - 1;
+    std::vector<int> rows;
+    for ( int row = first; row <= last; ++row ) {
+        rows.push_back(row);
+    }
+    std::stable_sort(rows.begin(), rows.end(), [](int a, int b) { return std::abs(a - current_list_item) < std::abs(b - current_list_item); });
+
+    std::vector<int> visible;
+    std::vector<int> upcoming;
+    for ( int row : rows ) {
+        auto video = get_videoid_from_vector(video_vector[row]);
+        if ( video.first && video_needs_details(video.second) ) {
+            visible.push_back(video.second);
+        }
+    }
+    for ( int offset = 1; offset <= list_length; ++offset ) {
+        int row = ( viewport_direction == 1 ) ? last + offset : first - offset;
+        if (( row < 0 ) || ( row >= video_vector.size() )) {
+            break;
+        }
+        auto video = get_videoid_from_vector(video_vector[row]);
+        if ( video.first && video_needs_details(video.second) ) {
+            upcoming.push_back(video.second);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(viewport_mutex);
+        if (( visible == viewport_visible ) && ( upcoming == viewport_upcoming )) {
+            return;
+        }
+        viewport_visible.swap(visible);
+        viewport_upcoming.swap(upcoming);
+        ++viewport_generation;
+    }
+    wake_scheduler();
+}
 // Draw lists for popular, subscriptions, search and other videos.
 void draw_list_videos ( int top_w, int top_h, int bot_w, int bot_h, std::vector<std::string> video_vector ) {
 
@@ -1563,7 +3769,7 @@ void draw_list_videos ( int top_w, int top_h, int bot_w, int bot_h, std::vector<
 
     // Draw Scrollbar
     for ( int scrollbar = 0; scrollbar < scrollbar_length; ++scrollbar ) {
-        printf("\033[%d;%dH", top_h + scrollbar - 1, bot_w + 1 );
+        screen_move(top_h + scrollbar - 1, bot_w + 1);
         if ( scrollbar == 0 ) {
             scrollbar_character = "┳";
         } else if ( scrollbar == scrollbar_length - 1 ) {
@@ -1573,7 +3779,7 @@ void draw_list_videos ( int top_w, int top_h, int bot_w, int bot_h, std::vector<
         } else {
             scrollbar_character = "┃";
         }
-        std::cout << color_cyan << scrollbar_character << color_reset;
+        screen_write(scrollbar_character, color_cyan);
     }
 
     // UI positions and settings
@@ -1598,6 +3804,9 @@ void draw_list_videos ( int top_w, int top_h, int bot_w, int bot_h, std::vector<
     int length_title = dynamic_section - length_author;
 
     if ( current_list_item == 0 ) { list_shift = 0; }
+    if ( list_shift > std::max(0, video_vector_length - list_length) ) { // List shrunk since last draw
+        list_shift = std::max(0, video_vector_length - list_length);
+    }
     if ( current_list_item - list_shift >= list_length - 5 ) {
         if ( ! ( current_list_item + 5 >= last_item )) {
             ++list_shift;
@@ -1607,10 +3816,11 @@ void draw_list_videos ( int top_w, int top_h, int bot_w, int bot_h, std::vector<
             --list_shift;
         }
     }
+    publish_viewport(video_vector, list_length);
 
     for ( int line = 0; line < list_length; ++line ) { // Each menu list, line iterated downwards.
         if ( video_vector_length != 0 ) {
-            if ( video_vector_length <= line ) { break; }
+            if ( video_vector_length <= list_shown_item + list_shift ) { break; }
             auto video_vector_number = get_videoid_from_vector(video_vector[list_shown_item + list_shift]);
             title = inv_videos_vector[video_vector_number.second].title;
             author = inv_videos_vector[video_vector_number.second].author;
@@ -1621,12 +3831,7 @@ void draw_list_videos ( int top_w, int top_h, int bot_w, int bot_h, std::vector<
             if ( current_list_item == line + list_shift) {
                 current_selected_video = video_vector_number.second;
             }
-            subscribed = false;
-            for ( int channel = 0; channel < vec_subscribed_channels.size(); ++channel ) {
-                if ( vec_subscribed_channels[channel] == inv_videos_vector[video_vector_number.second].author_id ) {
-                    subscribed = true;
-                }
-            }
+            subscribed = config_list_contains(subscribed_channels, inv_videos_vector[video_vector_number.second].author_id);
             current_list_loaded = true;
         } else {
             title = "Loading...";
@@ -1634,42 +3839,43 @@ void draw_list_videos ( int top_w, int top_h, int bot_w, int bot_h, std::vector<
         }
 
         if ( current_list_item == line + list_shift) {
-            printf("\033[%d;%dH", top_h + line, top_w - 2);
-            std::cout << color_red << color_bold << "▶" << color_reset;
-            printf("\033[%d;%dH", top_h + line, bot_w - 2);
-            std::cout  << color_red << color_bold << "◀" << color_reset;
+            screen_move(top_h + line, top_w - 2);
+            screen_write("▶", color_red + color_bold);
+            screen_move(top_h + line, bot_w - 2);
+            screen_write("◀", color_red + color_bold);
         }
 
-        printf("\033[%d;%dH", top_h + line, top_w + 1); // Title
-        std::cout << color_bold << truncate(title, length_title) << color_reset;
+        screen_move(top_h + line, top_w + 1); // Title
+        screen_write(truncate(title, length_title), color_bold);
 
         if ( video_vector_length == 0 ) { break; }
 
-        printf("\033[%d;%dH", top_h + line, length_title + top_w + 2); // Video Length
+        screen_move(top_h + line, length_title + top_w + 2); // Video Length
         if ( current_list_item == line + list_shift) {
-            std::cout << color_bold << color_red << length << color_reset;
+            screen_write(length, color_bold + color_red);
         } else {
-            std::cout << color_bold << color_blue << length << color_reset;
+            screen_write(length, color_bold + color_blue);
         }
 
-        printf("\033[%d;%dH", top_h + line, length_title + top_w + 8); // author
+        screen_move(top_h + line, length_title + top_w + 8); // author
         if ( subscribed ) {
-            std::cout << color_bold << color_green << truncate(author, length_author - 9) << color_reset;
+            screen_write(truncate(author, length_author - 9), color_bold + color_green);
         } else {
-            std::cout << color_cyan << truncate(author, length_author - 9) << color_reset;
+            screen_write(truncate(author, length_author - 9), color_cyan);
         }
 
-        printf("\033[%d;%dH", top_h + line, pos_released); // released
-        std::cout << color_bold << released << color_reset;
-        printf("\033[%d;%dH", top_h + line, pos_released + 4);
-        std::cout << color_gray << "Ago" << color_reset;
+        screen_move(top_h + line, pos_released); // released
+        screen_write(released, color_bold);
+        screen_move(top_h + line, pos_released + 4);
+        screen_write("Ago", color_gray);
 
-        printf("\033[%d;%dH", top_h + line, pos_views); // Views
-        std::cout << color_bold << views << color_gray << " Views" << color_reset;
+        screen_move(top_h + line, pos_views); // Views
+        screen_write(views, color_bold);
+        screen_write(" Views", color_bold + color_gray);
 
         if ( favorite ) {
-            printf("\033[%d;%dH", top_h + line, pos_star); // Star
-            std::cout << color_yellow << "✦" << color_reset;
+            screen_move(top_h + line, pos_star); // Star
+            screen_write("✦", color_yellow);
         }
 
         ++list_shown_item;
@@ -1745,8 +3951,8 @@ void draw_box ( int top_w, int top_h, int bot_w, int bot_h, bool title, int type
                 skip = false;
                 continue;
             }
-            printf("\033[%d;%dH", x, y);
-            std::cout << frame_color << character.c_str() << color_reset;
+            screen_move(x, y);
+            screen_write(character, frame_color);
         }
     }
     if ( title ) {
@@ -1756,8 +3962,10 @@ void draw_box ( int top_w, int top_h, int bot_w, int bot_h, bool title, int type
         subtract = subtract / 2;
         subtract = subtract + 1;
         m = m - subtract;
-        printf("\033[%d;%dH", top_h, m);
-        std::cout << frame_color << "┨ " << frame_title_color << color_bold << title_str << color_reset << frame_color << " ┠" << color_reset;
+        screen_move(top_h, m);
+        screen_write("┨ ", frame_color);
+        screen_write(title_str, frame_color + frame_title_color + color_bold);
+        screen_write(" ┠", frame_color);
     }
 }
 // Draw popup video box for detailed information about video
@@ -1772,6 +3980,7 @@ void draw_popup_box_video ( int top_w, int top_h, int bot_w, int bot_h, bool tit
     std::string video_author_id = inv_videos_vector[video_num].author_id;
     std::string video_description;
     std::string video_from_instance = inv_videos_vector[video_num].from_popular_instance;
+    int video_popular_instances = inv_videos_vector[video_num].popular_instances;
 
     int video_released = inv_videos_vector[video_num].published;
     int video_views = inv_videos_vector[video_num].viewcount;
@@ -1780,17 +3989,9 @@ void draw_popup_box_video ( int top_w, int top_h, int bot_w, int bot_h, bool tit
     bool updated = inv_videos_vector[video_num].manual_update;
     bool downloaded = inv_videos_vector[video_num].downloaded;
     bool favorite = inv_videos_vector[video_num].favorite;
-    bool subscribed = false;
-
-    for ( int author_i = 0; author_i < vec_subscribed_channels.size(); ++author_i ) {
-        if ( vec_subscribed_channels[author_i] == video_author_id ) {
-            subscribed = true;
-        }
-    }
+    bool subscribed = config_list_contains(subscribed_channels, video_author_id);
     if ( ! updated ) {
-        if ( ! inv_videos_vector[video_num].priority_update ) {
-            inv_videos_vector[video_num].priority_update = true;
-        }
+        request_video_info(video_num); // Queued once, UI only holds a shared lock.
         video_description = "Loading...";
     } else {
         video_description = inv_videos_vector[video_num].description;
@@ -1803,8 +4004,8 @@ void draw_popup_box_video ( int top_w, int top_h, int bot_w, int bot_h, bool tit
     int middle = title_w / 2;
     title_subtract = title_subtract / 2;
     middle = middle - title_subtract;
-    printf("\033[%d;%dH", top_h + 2, middle);
-    std::cout << color_blue << color_bold << video_title << color_reset;
+    screen_move(top_h + 2, middle);
+    screen_write(video_title, color_blue + color_bold);
 
     int center = title_w / 2;
     int from_middle = center / 4 + 3;
@@ -1812,70 +4013,73 @@ void draw_popup_box_video ( int top_w, int top_h, int bot_w, int bot_h, bool tit
     int right_row = center + from_middle + 1;
 
     // Length
-    printf("\033[%d;%dH", top_h + 4, left_row - 8);
-    std::cout << "Length:";
-    printf("\033[%d;%dH", top_h + 4, left_row);
-    std::cout << seconds_to_list_format(video_length);
+    screen_move(top_h + 4, left_row - 8);
+    screen_write("Length:");
+    screen_move(top_h + 4, left_row);
+    screen_write(seconds_to_list_format(video_length));
 
     // Uploaded
-    printf("\033[%d;%dH", top_h + 4, right_row - 10);
-    std::cout << "Uploaded:";
-    printf("\033[%d;%dH", top_h + 4, right_row);
-    std::cout << uploaded_format(epoch() - video_released);
+    screen_move(top_h + 4, right_row - 10);
+    screen_write("Uploaded:");
+    screen_move(top_h + 4, right_row);
+    screen_write(uploaded_format(epoch() - video_released));
 
     // Subscribed
-    printf("\033[%d;%dH", top_h + 5, left_row - 12);
-    std::cout << "Subscribed:";
-    printf("\033[%d;%dH", top_h + 5, left_row);
+    screen_move(top_h + 5, left_row - 12);
+    screen_write("Subscribed:");
+    screen_move(top_h + 5, left_row);
     if ( subscribed ) {
-        std::cout << "Yes";
+        screen_write("Yes");
     } else {
-        std::cout << "No";
+        screen_write("No");
     }
 
     // Author
-    printf("\033[%d;%dH", top_h + 5, right_row - 8);
-    std::cout << "Author:";
-    printf("\033[%d;%dH", top_h + 5, right_row);
-    std::cout << video_author_name;
+    screen_move(top_h + 5, right_row - 8);
+    screen_write("Author:");
+    screen_move(top_h + 5, right_row);
+    screen_write(video_author_name);
 
     // Views
-    printf("\033[%d;%dH", top_h + 6, left_row - 7);
-    std::cout << "Views:";
-    printf("\033[%d;%dH", top_h + 6, left_row);
-    std::cout << abbreviated_number(video_views);
+    screen_move(top_h + 6, left_row - 7);
+    screen_write("Views:");
+    screen_move(top_h + 6, left_row);
+    screen_write(abbreviated_number(video_views));
 
     // ChannelID
-    printf("\033[%d;%dH", top_h + 6, right_row - 11);
-    std::cout << "ChannelID:";
-    printf("\033[%d;%dH", top_h + 6, right_row);
-    std::cout << video_author_id;
+    screen_move(top_h + 6, right_row - 11);
+    screen_write("ChannelID:");
+    screen_move(top_h + 6, right_row);
+    screen_write(video_author_id);
 
     // Downloaded
-    printf("\033[%d;%dH", top_h + 7, left_row - 12);
-    std::cout << "Downloaded:";
-    printf("\033[%d;%dH", top_h + 7, left_row);
+    screen_move(top_h + 7, left_row - 12);
+    screen_write("Downloaded:");
+    screen_move(top_h + 7, left_row);
     if ( downloaded ) {
-        std::cout << "Yes";
+        screen_write("Yes");
     } else {
-        std::cout << "No";
+        screen_write("No");
     }
 
     // Favorite
-    printf("\033[%d;%dH", top_h + 7, right_row - 10);
-    std::cout << "Favorite:";
-    printf("\033[%d;%dH", top_h + 7, right_row);
+    screen_move(top_h + 7, right_row - 10);
+    screen_write("Favorite:");
+    screen_move(top_h + 7, right_row);
     if ( favorite ) {
-        std::cout << "Yes";
+        screen_write("Yes");
     } else {
-        std::cout << "No";
+        screen_write("No");
     }
 
     // Got from instance: from_popular_instance
-    printf("\033[%d;%dH", top_h + 8, left_row - 15);
-    std::cout << "From Instance:";
-    printf("\033[%d;%dH", top_h + 8, left_row);
-    std::cout << truncate(video_from_instance, right_row - left_row + 10);
+    screen_move(top_h + 8, left_row - 15);
+    screen_write("From Instance:");
+    screen_move(top_h + 8, left_row);
+    if ( video_popular_instances > 1 ) {
+        video_from_instance += " (+" + std::to_string(video_popular_instances - 1) + ")"; // Also in popular of other instances
+    }
+    screen_write(truncate(video_from_instance, right_row - left_row + 10));
 
     // description
     description( top_w + 2, top_h + 11, bot_w - 2, bot_h, video_description );
@@ -1921,8 +4125,8 @@ void menu_item_main ( int w, int h ) {
 
     //Version number
     if ( debug && large_canvas ) {
-        printf("\033[%d;%dH", 2, 3);
-        std::cout << "v" << version_number;
+        screen_move(2, 3);
+        screen_write("v" + version_number);
     }
 
     // Draw main menu logo
@@ -1933,8 +4137,8 @@ void menu_item_main ( int w, int h ) {
     int logo_array_size = sizeof(logo) / sizeof(logo[0]);
 
     for ( int l = 0; l < logo_array_size; ++l ) {
-        printf("\033[%d;%dH", l + 2, main_menu_logo_starting_pos);
-        std::cout << main_menu_logo_title_color << logo[l] << color_reset;
+        screen_move(l + 2, main_menu_logo_starting_pos);
+        screen_write(logo[l], main_menu_logo_title_color);
     }
 
     // Draw menu list
@@ -1944,10 +4148,11 @@ void menu_item_main ( int w, int h ) {
     int menu_list_array_size = sizeof(menu_items) / sizeof(menu_items[0]);
 
     for ( int i = 0; i < menu_list_array_size; ++i ) {
-        printf("\033[%d;%dH", menu_list_info_height + i, menu_list_number_width);
-        std::cout << color_red << color_bold << i + 1 << color_reset << ",";
-        printf("\033[%d;%dH", menu_list_info_height + i, menu_list_title_width);
-        std::cout << color_green << menu_items[i] << color_reset; if ( i == 0 ) { std::cout << " (Current)"; }
+        screen_move(menu_list_info_height + i, menu_list_number_width);
+        screen_write(std::to_string(i + 1), color_red + color_bold);
+        screen_write(",");
+        screen_move(menu_list_info_height + i, menu_list_title_width);
+        screen_write(menu_items[i], color_green); if ( i == 0 ) { screen_write(" (Current)"); }
     }
 }
 // Browse menu page
@@ -1971,11 +4176,11 @@ void menu_item_browse ( int w, int h ) {
     draw_box( box2_top_w, box2_top_h, box2_bot_w, box2_bot_h, true, 4, default_frame_color, "< " + browse_types[current_browse_type] + " >" );
 
     // Sats:
-    printf("\033[%d;%dH", 2, 3 + 1);
+    screen_move(2, 3 + 1);
     if ( current_browse_type == 0 ) {
-        std::cout << current_list_item + 1 << " / " << vec_browse_popular.size() << " Videos";
+        screen_write(std::to_string(current_list_item + 1) + " / " + std::to_string(vec_browse_popular.size()) + " Videos");
     } else if ( current_browse_type == 1 ) {
-        std::cout << current_list_item + 1 << " / " << vec_browse_subscriptions.size() << " Videos";
+        screen_write(std::to_string(current_list_item + 1) + " / " + std::to_string(vec_browse_subscriptions.size()) + " Videos");
     }
 
     if ( popup_box ) { // Popup popup for selected video
@@ -2077,35 +4282,39 @@ void menu_item_search ( int w, int h ) {
             draw_box( search_field_top_w - horizontal_field_extend, search_field_top_h, search_field_bot_w + horizontal_field_extend + 1, search_field_bot_h, false, 0, color_cyan );
 
             if ( search_field == 1 ) {
-                printf("\033[%d;%dH", vertical_center - 3, search_field_top_w + 5);
-                std::cout << color_red << "▶" << color_reset;
-                printf("\033[%d;%dH", vertical_center - 3, search_field_bot_w - 5);
-                std::cout << color_red << "◀" << color_reset;
+                screen_move(vertical_center - 3, search_field_top_w + 5);
+                screen_write("▶", color_red);
+                screen_move(vertical_center - 3, search_field_bot_w - 5);
+                screen_write("◀", color_red);
             } else if ( search_field == 0 ) {
-                printf("\033[%d;%dH", vertical_center, search_field_top_w - 2 - horizontal_field_extend);
-                std::cout << color_red << "▶" << color_reset;
-                printf("\033[%d;%dH", vertical_center, search_field_bot_w + 3 + horizontal_field_extend);
-                std::cout << color_red << "◀" << color_reset;
+                screen_move(vertical_center, search_field_top_w - 2 - horizontal_field_extend);
+                screen_write("▶", color_red);
+                screen_move(vertical_center, search_field_bot_w + 3 + horizontal_field_extend);
+                screen_write("◀", color_red);
             }
 
             // Type
-            printf("\033[%d;%dH", vertical_center - 3, horizontal_center - 9 );
-            std::cout << color_gray << "Type:" << color_reset;
-            printf("\033[%d;%dH", vertical_center - 3, horizontal_center);
+            screen_move(vertical_center - 3, horizontal_center - 9);
+            screen_write("Type:", color_gray);
+            screen_move(vertical_center - 3, horizontal_center);
             if ( search_type == 0 ) {
-                std::cout << color_green << color_bold << "<  Video  >" << color_reset;
+                screen_write("<  Video  >", color_green + color_bold);
             } else {
-                std::cout << color_green << color_bold << "< Channel >" << color_reset;
+                screen_write("< Channel >", color_green + color_bold);
             }
 
             // Search box content
-            printf("\033[%d;%dH", vertical_center, search_field_top_w - horizontal_field_extend + 2);
-            if ( typing_mode_result ) {
-                std::cout << color_green << color_bold << "LOADING..." << color_reset;
-            } else if ( search_string_length == 0 ) {
-                std::cout << color_gray << "Search..." << color_reset;
+            screen_move(vertical_center, search_field_top_w - horizontal_field_extend + 2);
+            if ( search_string_length == 0 ) {
+                screen_write("Search...", color_gray);
             } else {
-                std::cout << color_yellow << color_bold << ascii_vector_to_string(input_list_type) << color_reset;
+                screen_write(ascii_vector_to_string(input_list_type), color_yellow + color_bold);
+            }
+
+            // Search progress
+            if ( ! search_status.empty() ) {
+                screen_move(vertical_center + 3, horizontal_center - search_status.length() / 2);
+                screen_write(search_status, search_running ? color_green + color_bold : color_red + color_bold);
             }
         }
     }
@@ -2121,6 +4330,83 @@ void menu_item_status ( int w, int h ) {
     int box_bot_h = h - vertical_border;
 
     draw_box( box_top_w, box_top_h, box_bot_w, box_bot_h, true, 0, default_frame_color, "Status" );
+
+    // Connection stats
+    screen_move(box_top_h + 2, box_top_w + 3);
+    screen_write("Connections:", color_gray);
+    screen_move(box_top_h + 3, box_top_w + 5);
+    screen_write("New: ");
+    screen_write(std::to_string(fetch_connections_new), color_bold);
+    screen_write("  Reused: ");
+    screen_write(std::to_string(fetch_connections_reused), color_bold);
+    screen_write("  Hedged: ");
+    screen_write(std::to_string(fetch_hedges_sent), color_bold);
+    screen_write("  Hedges won: ");
+    screen_write(std::to_string(fetch_hedges_won), color_bold);
+    screen_write("  Paused instances: ");
+    screen_write(std::to_string(instance_breakers_open()), color_bold);
+
+    // Render stats
+    screen_move(box_top_h + 5, box_top_w + 3);
+    screen_write("Rendering:", color_gray);
+    screen_move(box_top_h + 6, box_top_w + 5);
+    screen_write("Last frame: ");
+    screen_write(std::to_string(frame_last_bytes), color_bold);
+    screen_write(" bytes in ");
+    screen_write(std::to_string(frame_last_syscalls), color_bold);
+    screen_write(" writes");
+    screen_move(box_top_h + 7, box_top_w + 5);
+    screen_write("Frames: ");
+    screen_write(std::to_string(frame_count), color_bold);
+    screen_write("  Average: ");
+    screen_write(std::to_string(frame_count == 0 ? 0 : frame_total_bytes / frame_count), color_bold);
+    screen_write(" bytes");
+
+    // Field projection stats
+    screen_move(box_top_h + 9, box_top_w + 3);
+    screen_write("Responses:", color_gray);
+    for ( int endpoint = 0; endpoint < api_endpoint_count; ++endpoint ) {
+        const api_endpoint_info& info = api_endpoints[endpoint];
+        long long saved = api_bytes_saved((api_endpoint)endpoint);
+        screen_move(box_top_h + 10 + endpoint, box_top_w + 5);
+        screen_write(info.name);
+        screen_move(box_top_h + 10 + endpoint, box_top_w + 17);
+        screen_write(std::to_string(info.projected_requests), color_bold);
+        screen_write(" requests, ");
+        screen_write(std::to_string(info.projected_bytes / 1024), color_bold);
+        screen_write(" KiB  Saved: ");
+        screen_write(saved < 0 ? "-" : std::to_string(saved / 1024) + " KiB", color_bold);
+    }
+
+    // Job stats
+    size_t queued[job_priority_count];
+    {
+        std::lock_guard<std::mutex> lock(job_mutex);
+        for ( int priority = 0; priority < job_priority_count; ++priority ) {
+            queued[priority] = job_queues[priority].size();
+        }
+    }
+    screen_move(box_top_h + 10 + api_endpoint_count + 1, box_top_w + 3);
+    screen_write("Jobs:", color_gray);
+    screen_move(box_top_h + 10 + api_endpoint_count + 2, box_top_w + 5);
+    screen_write("Threads: ");
+    screen_write(std::to_string(job_threads), color_bold);
+    screen_write("  Completed: ");
+    screen_write(std::to_string(jobs_completed), color_bold);
+    screen_write("  Parse threads: ");
+    screen_write(std::to_string(parse_threads), color_bold);
+    screen_write("  Parsed: ");
+    screen_write(std::to_string(parse_tasks_done), color_bold);
+    screen_write("  Stolen: ");
+    screen_write(std::to_string(parse_tasks_stolen), color_bold);
+    screen_move(box_top_h + 10 + api_endpoint_count + 3, box_top_w + 5);
+    screen_write("Queued:");
+    for ( int priority = 0; priority < job_priority_count; ++priority ) {
+        screen_write(" ");
+        screen_write(job_priority_names[priority]);
+        screen_write(" ");
+        screen_write(std::to_string(queued[priority]), color_bold);
+    }
 }
 // Settings menu page
 void menu_item_settings ( int w, int h ) {
@@ -2180,14 +4466,14 @@ void menu_item_settings ( int w, int h ) {
 
             for ( int line = 0; line < list_length; ++line ) {
                 if ( line < inv_instances_vector.size() ) {
-                    printf("\033[%d;%dH", fixed_height + 3 + line, 5);
-                    std::cout << truncate(inv_instances_vector[line + list_shift].name, box_left_bot_w - box_left_top_w - 7 - scrollbar_space );
+                    screen_move(fixed_height + 3 + line, 5);
+                    screen_write(truncate(inv_instances_vector[line + list_shift].name, box_left_bot_w - box_left_top_w - 7 - scrollbar_space ));
 
                     if ( current_list_item == line + list_shift ) {
-                        printf("\033[%d;%dH", fixed_height + 3 + line, box_left_top_w + 2);
-                        std::cout << color_red << color_bold << "▶" << color_reset;
-                        printf("\033[%d;%dH", fixed_height + 3 + line, box_left_bot_w - 2 - scrollbar_space);
-                        std::cout  << color_red << color_bold << "◀" << color_reset;
+                        screen_move(fixed_height + 3 + line, box_left_top_w + 2);
+                        screen_write("▶", color_red + color_bold);
+                        screen_move(fixed_height + 3 + line, box_left_bot_w - 2 - scrollbar_space);
+                        screen_write("◀", color_red + color_bold);
                     }
                 }
             }
@@ -2208,7 +4494,7 @@ void menu_item_settings ( int w, int h ) {
 
                 // Draw Scrollbar
                 for ( int scrollbar = 0; scrollbar < scrollbar_length; ++scrollbar ) {
-                    printf("\033[%d;%dH", fixed_height + 2 + scrollbar, box_left_bot_w - 2 );
+                    screen_move(fixed_height + 2 + scrollbar, box_left_bot_w - 2);
                     if ( scrollbar == 0 ) {
                         scrollbar_character = "┳";
                     } else if ( scrollbar == scrollbar_length - 1 ) {
@@ -2218,7 +4504,7 @@ void menu_item_settings ( int w, int h ) {
                     } else {
                         scrollbar_character = "┃";
                     }
-                    std::cout << color_cyan << scrollbar_character << color_reset;
+                    screen_write(scrollbar_character, color_cyan);
                 }
             }
 
@@ -2229,44 +4515,44 @@ void menu_item_settings ( int w, int h ) {
             bool instance_enabled = inv_instances_vector[current_list_item].enabled;
 
             // Title
-            printf("\033[%d;%dH", settings_item_height, settings_item_width); // Title
+            screen_move(settings_item_height, settings_item_width); // Title
             if ( instance_enabled ) {
-                std::cout << color_green << current_selected_instance_name << color_reset;
+                screen_write(current_selected_instance_name, color_green);
             } else {
-                std::cout << color_red << current_selected_instance_name << color_reset;
+                screen_write(current_selected_instance_name, color_red);
             }
 
             // Enabled Disabled
-            printf("\033[%d;%dH", settings_item_height + 1, settings_item_width);
+            screen_move(settings_item_height + 1, settings_item_width);
             if ( instance_enabled ) {
-                std::cout << color_green << "Instance: Enabled" << color_reset;
+                screen_write("Instance: Enabled", color_green);
             } else {
-                std::cout << color_red << "Instance: Disabled" << color_reset;
+                screen_write("Instance: Disabled", color_red);
             }
 
             // API Enabled
-            printf("\033[%d;%dH", settings_item_height + 2, settings_item_width);
+            screen_move(settings_item_height + 2, settings_item_width);
             if ( inv_instances_vector[current_list_item].api_enabled ) {
-                std::cout << color_green << "API: Enabled" << color_reset;
+                screen_write("API: Enabled", color_green);
             } else {
-                std::cout << color_red << "API: Disabled" << color_reset;
+                screen_write("API: Disabled", color_red);
             }
 
             // Banned
-            printf("\033[%d;%dH", settings_item_height + 3, settings_item_width);
+            screen_move(settings_item_height + 3, settings_item_width);
             if ( inv_instances_vector[current_list_item].banned ) {
-                std::cout << color_green << "Banned: No" << color_reset;
+                screen_write("Banned: No", color_green);
             } else {
-                std::cout << color_red << "Banned: Yes" << color_reset;
+                screen_write("Banned: Yes", color_red);
             }
 
             // Last retry
-            printf("\033[%d;%dH", settings_item_height + 3, settings_item_width);
+            screen_move(settings_item_height + 3, settings_item_width);
             int last_retry = inv_instances_vector[current_list_item].last_get;
             if ( last_retry == 0 ) {
-                std::cout << "No previous failiures.";
+                screen_write("No previous failiures.");
             } else {
-                std::cout << "Last updated: " << pretty_format_time(epoch() - last_retry);
+                screen_write("Last updated: "); screen_write(pretty_format_time(epoch() - last_retry));
             }
         }
     } else if ( current_settings_type == 2 ) { // Subscriptions
@@ -2303,11 +4589,44 @@ void draw_ui ( int w, int h ) {
 void capture_interrupt (int signum) {
     interrupt = true;
     collapse_threads = true;
+    wake_ui();
+}
+// Capture terminal resize
+void capture_resize (int signum) {
+    wake_ui();
+}
+// Block main loop until input, redraw request, resize, refresh timer or escape timeout.
+void wait_for_ui_event ( int timer_fd ) {
+    struct pollfd fds[2];
+    fds[0].fd = ui_event_fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = timer_fd;
+    fds[1].events = POLLIN;
+
+    int ready = poll(fds, 2, decode_key_wait_ms(input_decoder));
+    if ( ready <= 0 ) { // Timeout or interrupted by signal
+        return;
+    }
+    uint64_t count;
+    if ( fds[0].revents & POLLIN ) {
+        ssize_t got = read(ui_event_fd, &count, sizeof(count)); // Reset counter
+        (void)got;
+    }
+    if ( fds[1].revents & POLLIN ) {
+        ssize_t got = read(timer_fd, &count, sizeof(count));
+        (void)got;
+        update_ui = true;
+    }
 }
 // Main
 int main ( int argc, char *argv[] ) {
 
+    setlocale(LC_CTYPE, ""); // Needed by wcwidth for character widths
+    if ( MB_CUR_MAX == 1 ) { // Not a UTF-8 locale, screen is drawn in UTF-8 anyway
+        setlocale(LC_CTYPE, "C.UTF-8");
+    }
     signal (SIGINT, capture_interrupt);
+    signal (SIGWINCH, capture_resize);
 
     // Parse arguments
     int argument_iteration = 0;
@@ -2330,6 +4649,12 @@ int main ( int argc, char *argv[] ) {
                     int argument_char_current = argument_as_string[argument_char_i];
                     if ( argument_char_current == 118 ) { debug = true; log("Debugging Enabled!"); }
                     else if ( argument_char_current == 104 ) { usage(); return 0; }
+                    else if ( argument_char_current == 106 ) { // -jN, job threads
+                        int threads = std::atoi(argument_as_string.c_str() + argument_char_i + 1);
+                        if (( threads < 1 ) || ( threads > 64 )) { std::cout << "Invalid thread count: " << argument_as_string << "\n"; usage(); return 1; }
+                        job_threads = threads;
+                        break;
+                    }
                     else { std::cout << "Unknown parameter: -" << argument_as_string[argument_char_i] << "\n"; usage(); return 1; }
                 }
             }
@@ -2339,7 +4664,7 @@ int main ( int argc, char *argv[] ) {
             return 1;
         }
         //if ( argument_char_0 == "-" ) { std::cout << "Matching Single Dash!\n"; }
-        log("Success on parsing parameter: " + argument_as_string);
+        log_debug("Success on parsing parameter: {}", argument_as_string);
     }
 
     // Pre-Flight checks.
@@ -2356,26 +4681,45 @@ int main ( int argc, char *argv[] ) {
     std::string line;
     std::ifstream config_file_banned_channels_file(config_file_banned_channels);
     std::ifstream config_file_banned_instances_file(config_file_banned_instances);
-    std::ifstream config_file_subscriptions_file(config_file_subscriptions);
-    std::ifstream config_file_downloads_file(config_file_downloads);
-    std::ifstream config_file_favorites_file(config_file_favorites);
-    while (std::getline(config_file_banned_channels_file, line)) { log("Loading banned channel from file: " + line); vec_global_banned_channels.push_back(line); }
-    while (std::getline(config_file_banned_instances_file, line)) { log("Loading banned instance from file: " + line); vec_global_banned_instances.push_back(line); }
-    while (std::getline(config_file_subscriptions_file, line)) { log("Loading subscriptions from file: " + line); vec_subscribed_channels.push_back(line); }
-    while (std::getline(config_file_downloads_file, line)) { log("Loading downloads from file: " + line); vec_downloaded_videos.push_back(line); }
-    while (std::getline(config_file_favorites_file, line)) { log("Loading favorites from file: " + line); vec_favorited_videos.push_back(line); }
-
-    // Start process for updating local instances.
-    std::thread background_thread(THREAD_background_worker);
-    background_thread.detach();
+    while (std::getline(config_file_banned_channels_file, line)) { log_debug("Loading banned channel from file: {}", line); vec_global_banned_channels.push_back(line); }
+    while (std::getline(config_file_banned_instances_file, line)) { log_debug("Loading banned instance from file: {}", line); vec_global_banned_instances.push_back(line); }
+    if ( ! config_list_load(subscribed_channels, config_file_subscriptions) ) { std::cout << "Unable to load config file: " << config_file_subscriptions << "\n"; return 1; }
+    if ( ! config_list_load(downloaded_videos, config_file_downloads) ) { std::cout << "Unable to load config file: " << config_file_downloads << "\n"; return 1; }
+    if ( ! config_list_load(favorited_videos, config_file_favorites) ) { std::cout << "Unable to load config file: " << config_file_favorites << "\n"; return 1; }
+
+    // Load cached videos and lists, so UI can be drawn before anything is fetched.
+    load_cache();
+
+    // Init curl before any thread starts fetching.
+    if ( ! init_curl() ) { std::cout << "Unable to initialize curl\n"; return 1; }
+
+    // Event sources for main loop
+    ui_event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    int ui_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if ( ui_event_fd == -1 || ui_timer_fd == -1 ) { std::cout << "Unable to create event file descriptors\n"; return 1; }
+    struct itimerspec ui_timer_interval = {};
+    ui_timer_interval.it_value.tv_sec = ui_refresh_seconds;
+    ui_timer_interval.it_interval.tv_sec = ui_refresh_seconds;
+    timerfd_settime(ui_timer_fd, 0, &ui_timer_interval, NULL);
+
+    // Start log writer, lines logged so far are waiting in queue.
+    std::thread log_thread = start_log_writer();
+
+    // Start parse pool, job threads, and scheduler planning their work.
+    start_parse_pool();
+    for ( int lane = 0; lane < job_threads; ++lane ) {
+        std::thread job_thread(THREAD_job_worker, lane);
+        job_thread.detach();
+    }
+    std::thread scheduler_thread(THREAD_scheduler);
+    scheduler_thread.detach();
 
     // Local UI Elements
     int tmp_w, tmp_h, w, h; // Used to store previous window size to detect changes.
     struct winsize size;
-    int last_ui_update = 0;
 
-    //std::cout << "\033c"; // Clear screen.
-    std::cout << "\e[?25l"; // remove cursor
+    frame_buffer += "\e[?25l"; // remove cursor
+    frame_write();
 
     std::thread input_thread(THREAD_input); // Start input thread
 
@@ -2398,11 +4742,7 @@ int main ( int argc, char *argv[] ) {
 
         if ( ( current_menu == 1 ) && ( ! browse_opened ) ) {
             browse_opened = true;
-        }
-
-        if ( epoch() > last_ui_update + 9 ) { // updates every 10 seconds.
-            update_ui = true;
-            last_ui_update = epoch();
+            wake_scheduler();
         }
 
         calculate_inputs();
@@ -2410,52 +4750,66 @@ int main ( int argc, char *argv[] ) {
         ioctl(STDOUT_FILENO, TIOCGWINSZ, &size);
         w = size.ws_col; h = size.ws_row;
         if ( w < 80 || h < 20 ) { 
-            std::cout << "\033c";
-            std::cout << "Terminal too small!\nCurrent: Width: " << w << " Heigth: " << h << "\n\nMore Needed: ";
+            frame_buffer += "\033c";
+            frame_buffer += "Terminal too small!\nCurrent: Width: " + std::to_string(w) + " Heigth: " + std::to_string(h) + "\n\nMore Needed: ";
 
             if ( w < 60 && h < 20 ) {
-                std::cout << "Width: " << 60 - w << " Height: " << 20 - h;
+                frame_buffer += "Width: " + std::to_string(60 - w) + " Height: " + std::to_string(20 - h);
             } else if ( w < 60 ) {
-                std::cout << "Width: " << 60 - w;
+                frame_buffer += "Width: " + std::to_string(60 - w);
             } else if ( h < 20 ) {
-                std::cout << "Height: " << 20 - h;
+                frame_buffer += "Height: " + std::to_string(20 - h);
             }
-            std::cout << "\n\nTotal Needed: Width 60 Height 20";
+            frame_buffer += "\n\nTotal Needed: Width 60 Height 20";
+            frame_write();
 
             tmp_w = w;
             tmp_h = h;
-            usleep(10000);
+            screen_invalidate(); // Message overwrote screen
+            wait_for_ui_event(ui_timer_fd);
             continue;
         }
 
         if ( tmp_w != w || tmp_h != h || update_ui == true ) {
-            std::cout << "\033c"; // Clear screen. Also reset.
             tmp_w = w;
             tmp_h = h;
             update_ui = false;
 
-            // This is where everything is drawn to STDOut.
-            draw_ui(w, h);
+            // Everything is drawn to screen back buffer, then only changed cells are sent to STDOut.
+            screen_resize(w, h);
+            screen_clear();
+            {
+                std::shared_lock<std::shared_mutex> lock(cache_mutex);
+                draw_ui(w, h);
+            }
+            screen_flush();
 
-            std::cout << "\e[?25l"; // remove cursor
-            fflush(stdout); // Flush STDOUT buffer
+            frame_buffer += "\e[?25l"; // remove cursor
+            frame_write(); // Whole frame in one write
+        }
+        if ( ! ( update_ui || quit || collapse_threads )) {
+            wait_for_ui_event(ui_timer_fd); // Sleep until something happens
         }
-        usleep(500);
     }
 
+    save_cache();
+
     fputs("\e[?25h", stdout); // Show cursor again.
     printf("\033[%d;%dH", h, 0); // move cursor to end of screen.
     std::cout << "\nPress any key to quit...";
 
     collapse_threads = true;
+    stop_parse_pool();
 
     if ( interrupt ) {
         log("Interrupt signal received", 4);
+        stop_log_writer(log_thread);
         std::cout << "\nInterrupt!\n";
         return 1;
     }
 
     input_thread.join();
+    stop_log_writer(log_thread);
 
     std::cout << "\nExiting...\n";
 